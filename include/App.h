@@ -1,12 +1,20 @@
 #pragma once
 #include <SDL.h>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include "Args.h"
 #include "Particle.h"
 #include "Color.h"
 #include "Timer.h"
-
-struct Edge { int a; int b; float w; };
+#include "EdgeKernels.h"
+#include "KdTree.h"
+#include "FrameArena.h"
+#include "Interaction.h"
+#include "PerfCounters.h"
+#include "Spawn.h"
+#include "Camera.h"
+#include "ShmStream.h"
 
 class App {
 public:
@@ -14,24 +22,65 @@ public:
     ~App();
 
     bool init(const Config& cfg);
-    void run();
+    // Devuelve el código de salida (distinto de 0 si --verify falló con --frames)
+    int run();
 
 private:
     void handleEvents(bool& running);
+    void configureGrid();
+    void selectSpatialIndex();
     void update(float dt);
 
+    // cámara: solo las celdas visibles (más un radio) arman aristas
+    void fitCamera();
+    void updateVisibleCells();
+    void refreshPausedView();
+
+    // un paso de integración; fuera de la vista, con --offscreen-rate K,
+    // cada partícula avanza 1 de cada K frames con un paso K veces más largo
+    struct StepParams {
+        float dt, s, c;
+        float dtSlow, sSlow, cSlow;
+        int   rate, phase;
+    };
+    StepParams stepParams(float dt) const;
+    inline void stepParticle(int i, const StepParams& sp);
+
     // versión secuencial
     void rebuildGridSequential();
-    void buildEdgesSeq(float dt);
+    void buildEdgesSeq(float dt, bool integrate = true);
+    void collectEdgesSeq(std::vector<Edge>& out, NeighborAccum* forces);
+
+    GridView gridView() const;
+    bool edgeWeightsNeeded() const;
 
     // versión paralela
 #ifdef USE_OPENMP
     void rebuildGridParallel(int maxThreads);
+    void rebuildGridRadix(int maxThreads);
+    bool useRadixGrid(int maxThreads) const;
+    void collectEdgesPar(std::vector<Edge>& out, int maxThreads, NeighborAccum* forces);
+    void verifyAgainstSeq();
 #endif
-    void buildEdgesPar(float dt);
+    void buildEdgesPar(float dt, bool integrate = true);
 
     void render();
     void setWindowTitle(float fps);
+    void printRunSummary() const;
+
+    // --perf-counters
+    void initPerfCounters();
+    double candidatePairs() const;
+    void reportPerf();
+
+    // --shm
+    void publishFrame();
+
+    // memoria transitoria del frame
+    void beginFrame();
+    void endFrame();
+    FrameArena& arena(int tid) { return *arenas_[tid]; }
+    size_t arenaPeakBytes() const;
 
     inline int cellId(int cx, int cy) const { return cy*gw_ + cx; }
 
@@ -42,21 +91,78 @@ private:
 
     std::vector<Particle> particles_;
     std::vector<Edge> edges_;
+    std::vector<NeighborAccum> forces_;   // --interact: se consumen en el frame siguiente
+
+    // una arena por hilo; todo lo que vive un solo frame sale de acá
+    std::vector<std::unique_ptr<FrameArena>> arenas_;
+    std::vector<ArenaVector<Edge>>           threadEdges_;
+    uint64_t frameHeapStart_      = 0;
+    uint64_t heapAllocsLastFrame_ = 0;
+
+    // mundo y vista
+    int    worldW_ = 1, worldH_ = 1;
+    Camera camera_;
+    bool   dragging_  = false;
+    bool   cullEdges_ = false;
+    CellRect visibleCells_;
+    float  viewX0_ = 0.f, viewY0_ = 0.f, viewX1_ = 0.f, viewY1_ = 0.f;  // vista + radio
+    long   simFrame_ = 0;
 
     // grid plano
     int gw_ = 1, gh_ = 1;
     float cellSize_ = 80.f;
+    bool  gridReshaped_ = false;   // configureGrid() cambió gw_/gh_ desde el último índice
+    int   cellSubdiv_ = 1;      // celdas de lado radius / cellSubdiv_
+    HalfStencil stencil_;
+
+    // índice alternativo para distribuciones muy agrupadas
+    KdTree kdTree_;
+    bool   useKdTree_       = false;
+    int    indexCheckFrame_ = 0;
+    double clustering_      = 1.0;  // Σk² / esperado uniforme
     std::vector<int>   cellCounts_;
     std::vector<int>   cellOffsets_;
     std::vector<int>   cellItems_;
+    bool radixGrid_ = false;   // el último grid PAR salió del radix sort
 #ifdef USE_OPENMP
     std::vector<int> particleCellIds_;
     std::vector<int> perThreadCounts_;
     std::vector<int> perThreadOffsets_;
+
+    // modo determinista: bolsita y rango de salida de cada bloque de celdas
+    std::vector<int>    detBlockThread_;
+    std::vector<size_t> detBlockStart_;
+    std::vector<size_t> detBlockOffset_;
+
+    // --verify
+    std::vector<int>  verifyGrid_;
+    std::vector<Edge> verifySeqEdges_;
+    std::vector<Edge> verifyParEdges_;
+    std::vector<NeighborAccum> verifyForces_;
 #endif
+    long verifyFrames_   = 0;
+    long verifyFailures_ = 0;
 
     Timer timer_;
 
+    ShmPublisher shm_;
+    uint64_t shmFrame_ = 0;
+    bool     shmCutWarned_ = false;   // ya se avisó que las aristas no entran
+    double   simTime_  = 0.0;   // segundos simulados
+
+    PerfCounters perf_;
+    long perfFrames_ = 0;   // frames acumulados desde el último reporte
+    double perfPairs_ = 0.0; // pares candidatos de esos frames, sumados en cada pasada de aristas
+
+    // --frames: tiempos acumulados (sin los frames de calentamiento)
+    struct RunStats {
+        double updateSec = 0.0;
+        double renderSec = 0.0;
+        double publishSec = 0.0;
+        double edges     = 0.0;
+        long   frames    = 0;
+    } runStats_;
+
     bool  paused_        = false;
     int   rotationSign_  = 0;     
     float rotationSpeed_ = 1.6f;  
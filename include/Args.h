@@ -1,17 +1,45 @@
 #pragma once
 #include <string>
+#include <cstdint>
+
+// Índice espacial para buscar vecinos
+enum class IndexMode : uint8_t { Grid=0, KdTree=1, Auto=2 };
+
+// Cómo se arma el grid plano en PAR: conteos por hilo y celda, o radix sort
+enum class GridBuild : uint8_t { Counts=0, Radix=1, Auto=2 };
+
+// Distribución inicial de las partículas
+enum class SpawnDist : uint8_t { Uniform=0, Blobs=1, Rings=2 };
+
+// Interacción entre partículas calculada en el mismo barrido de aristas
+enum class InteractMode : uint8_t { Off=0, Boids=1, Repel=2 };
 
 struct Config {
     int   width  = 1280;
     int   height = 720;
+    int   worldW = 0, worldH = 0;  // tamaño del mundo (0 = el de la ventana)
+    float zoom   = 0.f;            // zoom inicial (0 = todo el mundo a la vista)
+    int   offscreenRate = 1;       // fuera de la vista se integra 1 de cada K frames
     int   n      = 400;
     float radius = 120.f;
     float speed  = 1.f;
     bool  parallel = false;
     unsigned int seed = 0;
+    SpawnDist dist = SpawnDist::Uniform;
     int   threads = 0;
     bool  bench   = false;
     bool  novsync = false;
+    bool  deterministic = false; // PAR con aristas en el mismo orden que SEQ
+    bool  verify  = false;       // compara PAR contra SEQ en cada frame
+    int   cellSubdiv = 1;        // celdas de lado r/cellSubdiv (0 = auto)
+    IndexMode index = IndexMode::Grid;
+    GridBuild gridBuild = GridBuild::Auto;
+    InteractMode interact = InteractMode::Off;
+    int   frames  = 0;           // >0: corre N frames con dt fijo y termina
+    bool  perfCounters = false;  // contadores de hardware por fase (perf_event_open)
+    std::string shmName;         // --shm: publica cada frame en memoria compartida
+    int   shmSlots    = 4;       // slots del anillo
+    int   shmMaxEdges = 0;       // aristas por slot (0 = según los pares esperados)
 };
 
 bool parseArgs(int argc, char** argv, Config& out, std::string& error);
@@ -0,0 +1,42 @@
+#pragma once
+
+// Vista 2D sobre un mundo que puede ser más grande que la ventana.
+// (x, y) es el punto del mundo en la esquina superior izquierda y `zoom`
+// cuántos píxeles ocupa una unidad de mundo.
+struct Camera {
+    float x = 0.f, y = 0.f;
+    float zoom = 1.f;
+    int   viewW = 1, viewH = 1;
+    float minZoom = 0.05f, maxZoom = 20.f;
+
+    inline float toScreenX(float wx) const { return (wx - x) * zoom; }
+    inline float toScreenY(float wy) const { return (wy - y) * zoom; }
+
+    // Todo el mundo en la ventana, centrado. El zoom mínimo queda en la mitad.
+    void fit(float worldW, float worldH);
+    // Centra en el mundo con un zoom dado
+    void centerOn(float worldW, float worldH, float z);
+
+    // Zoom manteniendo fijo el punto del mundo bajo el píxel (sx, sy)
+    void zoomAt(float factor, int sx, int sy);
+    void pan(int dxPixels, int dyPixels);
+    // No deja que la vista se vaya del todo fuera del mundo
+    void clampTo(float worldW, float worldH);
+
+    // Rectángulo visible en coordenadas de mundo, ampliado en `margin`
+    void visibleRect(float margin, float& x0, float& y0, float& x1, float& y1) const;
+    bool coversWorld(float worldW, float worldH) const;
+};
+
+// Rectángulo de celdas del grid que arman aristas en el frame. Las unidades
+// de trabajo se numeran fila por fila dentro del rectángulo; con el grid
+// entero (cx0 = cy0 = 0, cols = gw) la unidad es directamente la celda.
+struct CellRect {
+    int cx0 = 0, cy0 = 0;
+    int cols = 1, rows = 1;
+
+    inline int count() const { return cols * rows; }
+    inline int cell(int unit, int gw) const {
+        return (cy0 + unit / cols) * gw + cx0 + unit % cols;
+    }
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include "Particle.h"
+
+struct Edge { int a; int b; float w; };
+
+// Medio stencil precalculado para celdas de lado `cellSize`. La entrada 0 es
+// la propia celda; el resto son las vecinas "hacia adelante" (misma fila a la
+// derecha o filas de abajo) cuya distancia mínima a la celda no supera el
+// radio. Cada par de celdas se visita una sola vez.
+struct HalfStencil {
+    std::vector<int> dx, dy;
+    std::vector<int> delta;   // dy*gw + dx, para celdas interiores
+    int reach = 1;            // máximo |dx| / dy en celdas
+};
+
+HalfStencil buildHalfStencil(float cellSize, float radius, int gw);
+
+// Vista de solo lectura del grid plano que usan los kernels de aristas.
+struct GridView {
+    const Particle* particles;
+    const int*      cellOffsets;
+    const int*      cellItems;
+    int   gw, gh;
+    float r2, invR2;
+
+    const int* stencilDx;
+    const int* stencilDy;
+    const int* stencilDelta;
+    int        stencilSize;
+    int        stencilReach;
+};
+
+// Destino por defecto: agrega las aristas a un vector (std::vector o
+// ArenaVector). Un destino recibe también dx, dy (de b hacia a) y d² por si
+// necesita algo más que la arista.
+template <class Vec>
+struct EdgeVectorSink {
+    Vec& out;
+    inline void emit(int a, int b, float w, float, float, float) { out.push_back({ a, b, w }); }
+};
+
+// Pares entre la celda `cell` y `other`. Con SameCell se recorre solo el
+// triángulo superior (idxB > idxA). Sin WithWeights no se calcula `w`.
+template <bool SameCell, bool WithWeights, class Sink>
+inline void edgeCellPairs(const GridView& g, int cell, int other, Sink& sink) {
+    const Particle* ps    = g.particles;
+    const int*      items = g.cellItems;
+    const int cellStart  = g.cellOffsets[cell];
+    const int cellEnd    = g.cellOffsets[cell + 1];
+    const int otherStart = g.cellOffsets[other];
+    const int otherEnd   = g.cellOffsets[other + 1];
+
+    for (int idxA = cellStart; idxA < cellEnd; ++idxA) {
+        const int   pA = items[idxA];
+        const float ax = ps[pA].x;
+        const float ay = ps[pA].y;
+        const int   first = SameCell ? idxA + 1 : otherStart;
+
+        for (int idxB = first; idxB < otherEnd; ++idxB) {
+            const int pB = items[idxB];
+            const float dx = ax - ps[pB].x;
+            const float dy = ay - ps[pB].y;
+            const float d2 = dx*dx + dy*dy;
+
+            if (d2 <= g.r2) {
+                sink.emit(pA, pB, WithWeights ? 1.f - d2 * g.invR2 : 0.f, dx, dy, d2);
+            }
+        }
+    }
+}
+
+// Todas las aristas cuyo primer extremo está en `cell`, en orden canónico.
+// Interior = todo el stencil cae dentro del grid, así que no hace falta
+// revisar bordes y la vecina sale de un desplazamiento plano.
+template <bool Interior, bool WithWeights, class Sink>
+inline void edgeCell(const GridView& g, int cell, Sink& sink) {
+    edgeCellPairs<true, WithWeights>(g, cell, cell, sink);
+
+    if (Interior) {
+        for (int k = 1; k < g.stencilSize; ++k) {
+            edgeCellPairs<false, WithWeights>(g, cell, cell + g.stencilDelta[k], sink);
+        }
+        return;
+    }
+
+    const int cx = cell % g.gw;
+    const int cy = cell / g.gw;
+    for (int k = 1; k < g.stencilSize; ++k) {
+        const int nx = cx + g.stencilDx[k];
+        const int ny = cy + g.stencilDy[k];
+        if (nx < 0 || nx >= g.gw || ny >= g.gh) continue;
+        edgeCellPairs<false, WithWeights>(g, cell, ny * g.gw + nx, sink);
+    }
+}
+
+// Punto de entrada común para SEQ y PAR: elige la instanciación según la
+// posición de la celda. Ambos modos terminan en exactamente el mismo código.
+template <bool WithWeights, class Sink>
+inline void edgeCellDispatch(const GridView& g, int cell, Sink& sink) {
+    const int cx = cell % g.gw;
+    const int cy = cell / g.gw;
+    const int reach = g.stencilReach;
+    if (cx >= reach && cx < g.gw - reach && cy < g.gh - reach) {
+        edgeCell<true,  WithWeights>(g, cell, sink);
+    } else {
+        edgeCell<false, WithWeights>(g, cell, sink);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator para datos que viven un solo frame. Se resetea al inicio de
+// cada frame; si en un frame no alcanzó el bloque, en el siguiente reset se
+// reemplaza por uno que cubra el máximo visto. En régimen estable el frame
+// no toca el heap.
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialBytes = 256 * 1024);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align);
+
+    template <class T>
+    T* alloc(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset();
+
+    size_t used()      const { return used_ + overflowBytes_; }
+    size_t capacity()  const { return capacity_; }
+    size_t highWater() const { return highWater_; }
+
+private:
+    char*  block_         = nullptr;
+    size_t capacity_      = 0;
+    size_t used_          = 0;
+    size_t overflowBytes_ = 0;
+    size_t highWater_     = 0;
+    std::vector<void*> overflow_;
+};
+
+// Allocator de STL sobre una FrameArena. deallocate no hace nada: la memoria
+// se recupera toda junta en el próximo reset.
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    FrameArena* arena = nullptr;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(FrameArena* a) : arena(a) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T*   allocate(size_t n)     { return arena->alloc<T>(n); }
+    void deallocate(T*, size_t) {}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Cantidad de llamadas a operator new desde que arrancó el programa.
+uint64_t heapAllocationCount();
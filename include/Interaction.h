@@ -0,0 +1,50 @@
+#pragma once
+#include <cmath>
+#include "Args.h"
+#include "Particle.h"
+#include "EdgeKernels.h"
+
+// Términos de interacción acumulados por partícula durante el barrido de
+// aristas; la integración del frame siguiente los consume.
+struct NeighborAccum {
+    float sepX, sepY;   // empuje lejos de los vecinos cercanos
+    float velX, velY;   // suma de velocidades vecinas (alineación)
+    float offX, offY;   // suma de (vecino - yo) (cohesión)
+    float count;        // vecinos dentro del radio
+};
+
+// Destino que, además de guardar la arista, suma las fuerzas del par sobre
+// ambos extremos. Así el enjambre sale del mismo recorrido del stencil.
+// Cada par escribe en `a` y en `b`: en PAR el barrido se organiza por franjas
+// de filas para que dos hilos nunca toquen la misma partícula a la vez.
+template <InteractMode Mode, class Vec>
+struct InteractionSink {
+    Vec&            out;
+    NeighborAccum*  acc;
+    const Particle* ps;
+    float           sepR2;   // radio² de separación (boids)
+
+    inline void emit(int a, int b, float w, float dx, float dy, float d2) {
+        out.push_back({ a, b, w });
+
+        // dx, dy apuntan de b hacia a
+        if (Mode == InteractMode::Repel || d2 < sepR2) {
+            const float s  = d2 > 1e-6f ? w / std::sqrt(d2) : 0.f;
+            const float sx = dx * s;
+            const float sy = dy * s;
+            acc[a].sepX += sx; acc[a].sepY += sy;
+            acc[b].sepX -= sx; acc[b].sepY -= sy;
+        }
+        if (Mode == InteractMode::Boids) {
+            acc[a].velX += ps[b].vx; acc[a].velY += ps[b].vy;
+            acc[b].velX += ps[a].vx; acc[b].velY += ps[a].vy;
+            acc[a].offX -= dx;       acc[a].offY -= dy;
+            acc[b].offX += dx;       acc[b].offY += dy;
+            acc[a].count += 1.f;
+            acc[b].count += 1.f;
+        }
+    }
+};
+
+// Aplica a la velocidad lo acumulado en el frame anterior.
+void applyInteraction(Particle& p, const NeighborAccum& acc, InteractMode mode, float dt);
@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Particle.h"
+#include "EdgeKernels.h"
+
+// Nodo del k-d tree. Los nodos van en preorden: el hijo izquierdo es id+1.
+// Cada nodo cubre un tramo contiguo de items y de hojas.
+struct KdNode {
+    float minX, minY, maxX, maxY;   // caja ajustada a sus partículas
+    int   begin, end;               // tramo en items
+    int   leafBegin, leafEnd;       // tramo de hojas que cuelgan de él
+    int   right;                    // hijo derecho, -1 si es hoja
+};
+
+// Vista para los kernels: las hojas hacen de "celdas" (leafOffsets/items),
+// así que los pares se prueban con el mismo edgeCellPairs del grid.
+struct KdView {
+    GridView      pairs;
+    const KdNode* nodes;
+    const int*    leafNode;
+};
+
+// k-d tree con hojas de hasta KD_LEAF_SIZE partículas, partido por la mediana
+// del eje más largo. La forma del árbol depende solo de N, así que la versión
+// paralela (tareas OpenMP) produce exactamente el mismo árbol que la secuencial.
+class KdTree {
+public:
+    static constexpr int KD_LEAF_SIZE = 16;
+
+    void build(const std::vector<Particle>& particles, int maxThreads);
+
+    int  leafCount() const { return (int)leafNode_.size(); }
+    const std::vector<int>& items() const { return items_; }
+    KdView view(const Particle* particles, float r2, float invR2) const;
+
+private:
+    void buildNode(int node, int begin, int end, int firstLeaf, bool spawnTasks);
+
+    const Particle*     ps_ = nullptr;
+    std::vector<KdNode> nodes_;
+    std::vector<int>    items_;
+    std::vector<int>    leafOffsets_;
+    std::vector<int>    leafNode_;
+};
+
+inline float kdBoxDist2(const KdNode& a, const KdNode& b) {
+    const float gx = std::max(0.f, std::max(a.minX - b.maxX, b.minX - a.maxX));
+    const float gy = std::max(0.f, std::max(a.minY - b.maxY, b.minY - a.maxY));
+    return gx*gx + gy*gy;
+}
+
+// Aristas cuyo primer extremo está en la hoja `leaf`: la hoja contra sí misma y
+// contra cada hoja posterior cuya caja quede a menos de r. Se baja por el árbol
+// podando por distancia entre cajas; el orden de salida es por hoja ascendente.
+template <bool WithWeights, class Sink>
+inline void kdLeafEdges(const KdView& kv, int leaf, Sink& sink) {
+    const KdNode& self = kv.nodes[kv.leafNode[leaf]];
+    edgeCellPairs<true, WithWeights>(kv.pairs, leaf, leaf, sink);
+
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const int id = stack[--top];
+        const KdNode& nd = kv.nodes[id];
+        if (nd.leafEnd <= leaf + 1) continue;
+        if (kdBoxDist2(self, nd) > kv.pairs.r2) continue;
+
+        if (nd.right < 0) {
+            edgeCellPairs<false, WithWeights>(kv.pairs, leaf, nd.leafBegin, sink);
+            continue;
+        }
+        stack[top++] = nd.right;
+        stack[top++] = id + 1;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Fases del frame que se miden por separado
+enum class PerfPhase : uint8_t { None=0, Integrate, Grid, Edges, Merge, Render, Publish, Count };
+
+// Contadores de hardware por hilo vía perf_event_open (solo Linux). Cada hilo
+// de OpenMP abre su propio grupo (ciclos, instrucciones, fallos de L1D y LLC,
+// fallos de predicción de saltos y de dTLB). Entre fases, con los hilos
+// quietos, el hilo principal lee todos los grupos y atribuye la diferencia a
+// la fase que termina. Los hilos ociosos tienen que esperar dormidos
+// (OMP_WAIT_POLICY=passive, ver main.cpp) para no sumar su espera activa.
+// Si el kernel no deja abrir los contadores, queda deshabilitado y mark()
+// no hace nada.
+class PerfCounters {
+public:
+    enum Event { Cycles=0, Instructions, L1DMisses, LLCMisses, BranchMisses, DTLBMisses, NumEvents };
+
+    ~PerfCounters();
+
+    // Abre el grupo del hilo que llama. Devuelve false si no hay contadores.
+    bool openForThread(int tid);
+    void setEnabled(bool on) { enabled_ = on; }
+    bool enabled() const { return enabled_; }
+    const std::string& error() const { return error_; }
+
+    // Cierra la fase en curso y empieza `next`
+    void mark(PerfPhase next) { if (enabled_) markSlow(next); }
+
+    // Tabla por fase desde el último reporte: IPC, fallos por partícula y,
+    // en la fase de aristas, por par candidato.
+    void report(std::ostream& os, double particles, double candidatePairs, long frames);
+    void resetTotals();
+
+private:
+    struct ThreadGroup {
+        int    fd[NumEvents]   = { -1, -1, -1, -1, -1, -1 };
+        int    slot[NumEvents] = { -1, -1, -1, -1, -1, -1 };  // posición en la lectura del grupo, -1 si no abrió
+        int    opened = 0;
+        double last[NumEvents] = {};
+    };
+    static_assert(NumEvents == 6, "actualizar los inicializadores de ThreadGroup");
+
+    void markSlow(PerfPhase next);
+    bool readGroup(ThreadGroup& g, double* scaled);
+
+    bool enabled_ = false;
+    std::string error_;
+    std::vector<ThreadGroup> groups_;
+    PerfPhase current_ = PerfPhase::None;
+    double totals_[(int)PerfPhase::Count][NumEvents] = {};
+};
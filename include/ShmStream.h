@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Stream de frames por memoria compartida POSIX (shm_open + mmap) para otros
+// procesos: un anillo de `slotCount` slots, cada uno con las partículas y las
+// aristas del frame en SoA. Cada slot lleva un seqlock: el publicador lo pone
+// impar mientras escribe y par al terminar; el lector lee en el lugar, sin
+// copiar, y descarta lo leído si el número cambió en el medio. El publicador
+// nunca espera a nadie.
+//
+// Este header define el formato y no depende de SDL, para que los lectores
+// (tools/shm_reader.cpp) lo incluyan solo.
+
+static constexpr uint32_t SHM_MAGIC   = 0x53534D31;  // "SSM1"
+static constexpr uint32_t SHM_VERSION = 2;
+static constexpr size_t   SHM_ALIGN   = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "el seqlock necesita atómicos de 64 bits sin lock");
+
+enum ShmState : uint32_t { SHM_LIVE = 1, SHM_CLOSED = 2 };
+
+// Primera página del segmento
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t maxParticles;
+    uint32_t maxEdges;
+    float    worldW, worldH;
+    uint64_t slotBytes;                  // tamaño de cada slot
+    uint64_t slotsOffset;                // inicio del primer slot
+    std::atomic<uint64_t> latestFrame;   // último frame completo (0 = ninguno)
+    std::atomic<uint32_t> state;         // ShmState
+    int32_t  publisherPid;               // proceso que publica (para ver si sigue vivo)
+};
+
+// Al inicio de cada slot; los arreglos SoA van detrás, alineados a 64 bytes
+struct alignas(SHM_ALIGN) ShmSlotHeader {
+    std::atomic<uint64_t> seq;   // impar: se está escribiendo
+    uint64_t frame;
+    double   simTime;            // segundos simulados
+    uint32_t numParticles;
+    uint32_t numEdges;           // aristas guardadas (≤ maxEdges)
+    uint32_t numEdgesTotal;      // aristas del frame; > numEdges si no entraron
+};
+
+// Punteros a los arreglos de un slot
+struct ShmFrame {
+    ShmSlotHeader* hdr = nullptr;
+    float   *x = nullptr, *y = nullptr, *vx = nullptr, *vy = nullptr;
+    uint8_t *r = nullptr, *g = nullptr, *b = nullptr;
+    int32_t *edgeA = nullptr, *edgeB = nullptr;
+    float   *edgeW = nullptr;
+};
+
+// Desplazamientos dentro de un slot; los usan el publicador y los lectores.
+struct ShmSlotLayout {
+    size_t x, y, vx, vy, r, g, b, edgeA, edgeB, edgeW;
+    size_t bytes;
+
+    static ShmSlotLayout make(uint32_t maxParticles, uint32_t maxEdges);
+    ShmFrame frame(void* slotBase) const;
+};
+
+inline ShmSlotLayout ShmSlotLayout::make(uint32_t maxParticles, uint32_t maxEdges) {
+    ShmSlotLayout l;
+    size_t at = sizeof(ShmSlotHeader);
+    auto place = [&](size_t elemBytes, size_t count) {
+        at = (at + SHM_ALIGN - 1) & ~(SHM_ALIGN - 1);
+        const size_t off = at;
+        at += elemBytes * count;
+        return off;
+    };
+    l.x     = place(sizeof(float),   maxParticles);
+    l.y     = place(sizeof(float),   maxParticles);
+    l.vx    = place(sizeof(float),   maxParticles);
+    l.vy    = place(sizeof(float),   maxParticles);
+    l.r     = place(sizeof(uint8_t), maxParticles);
+    l.g     = place(sizeof(uint8_t), maxParticles);
+    l.b     = place(sizeof(uint8_t), maxParticles);
+    l.edgeA = place(sizeof(int32_t), maxEdges);
+    l.edgeB = place(sizeof(int32_t), maxEdges);
+    l.edgeW = place(sizeof(float),   maxEdges);
+    l.bytes = (at + 4095) & ~(size_t)4095;
+    return l;
+}
+
+inline ShmFrame ShmSlotLayout::frame(void* slotBase) const {
+    char* base = static_cast<char*>(slotBase);
+    ShmFrame f;
+    f.hdr   = reinterpret_cast<ShmSlotHeader*>(base);
+    f.x     = reinterpret_cast<float*>(base + x);
+    f.y     = reinterpret_cast<float*>(base + y);
+    f.vx    = reinterpret_cast<float*>(base + vx);
+    f.vy    = reinterpret_cast<float*>(base + vy);
+    f.r     = reinterpret_cast<uint8_t*>(base + r);
+    f.g     = reinterpret_cast<uint8_t*>(base + g);
+    f.b     = reinterpret_cast<uint8_t*>(base + b);
+    f.edgeA = reinterpret_cast<int32_t*>(base + edgeA);
+    f.edgeB = reinterpret_cast<int32_t*>(base + edgeB);
+    f.edgeW = reinterpret_cast<float*>(base + edgeW);
+    return f;
+}
+
+// Lado del simulador: crea el segmento y escribe un slot por frame.
+class ShmPublisher {
+public:
+    ShmPublisher() = default;
+    ~ShmPublisher();
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    // Si ya existe un segmento con ese nombre solo se reemplaza cuando no hay
+    // un publicador vivo detrás (sin magic válido, SHM_CLOSED o su proceso ya
+    // no existe); si no, falla sin tocarlo.
+    bool open(const std::string& name, int slots, uint32_t maxParticles, uint32_t maxEdges,
+              float worldW, float worldH, std::string& error);
+    bool isOpen() const { return header_ != nullptr; }
+    uint32_t maxParticles() const { return header_ ? header_->maxParticles : 0; }
+    uint32_t maxEdges()     const { return header_ ? header_->maxEdges : 0; }
+
+    // begin marca el slot como "escribiendo" y devuelve sus arreglos;
+    // commit lo cierra y lo anuncia como el último frame.
+    ShmFrame begin(uint64_t frame, double simTime);
+    void commit(const ShmFrame& f, uint32_t numParticles, uint32_t numEdges,
+                uint32_t numEdgesTotal);
+
+private:
+    std::string    name_;
+    void*          base_   = nullptr;
+    size_t         bytes_  = 0;
+    ShmRingHeader* header_ = nullptr;
+    ShmSlotLayout  layout_{};
+};
+
+// Lado del lector: abre un segmento existente en solo lectura.
+class ShmReader {
+public:
+    ShmReader() = default;
+    ~ShmReader();
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    bool open(const std::string& name, std::string& error);
+    const ShmRingHeader& header() const { return *header_; }
+
+    // Llama fn(const ShmFrame&) sobre el último frame posterior a `after`,
+    // directamente sobre la memoria compartida. Si el publicador reescribió
+    // el slot mientras tanto se reintenta con el nuevo último frame.
+    // Devuelve el número de frame leído o 0 si no había uno nuevo.
+    template <class Fn>
+    uint64_t readLatest(uint64_t after, Fn&& fn, uint64_t* retries = nullptr);
+
+private:
+    void*                base_   = nullptr;
+    size_t               bytes_  = 0;
+    const ShmRingHeader* header_ = nullptr;
+    ShmSlotLayout        layout_{};
+};
+
+template <class Fn>
+uint64_t ShmReader::readLatest(uint64_t after, Fn&& fn, uint64_t* retries) {
+    for (;;) {
+        const uint64_t frame = header_->latestFrame.load(std::memory_order_acquire);
+        if (frame == 0 || frame <= after) return 0;
+
+        char* slot = static_cast<char*>(base_) + header_->slotsOffset +
+                     (frame % header_->slotCount) * header_->slotBytes;
+        const ShmFrame f = layout_.frame(slot);
+
+        const uint64_t s1 = f.hdr->seq.load(std::memory_order_acquire);
+        if ((s1 & 1) == 0 && f.hdr->frame == frame) {
+            fn(static_cast<const ShmFrame&>(f));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (f.hdr->seq.load(std::memory_order_relaxed) == s1) return frame;
+        }
+        if (retries) ++*retries;
+    }
+}
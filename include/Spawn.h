@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Args.h"
+#include "Particle.h"
+
+// Generador basado en contador: cada valor es un hash (finalizador de
+// SplitMix64) de (semilla, contador). No hay estado compartido, así que la
+// partícula i sale igual la genere el hilo que la genere.
+struct CounterRng {
+    uint64_t key;
+    uint64_t ctr;
+
+    static inline uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    inline uint64_t next() { return mix(key + 0x9E3779B97F4A7C15ull * ++ctr); }
+
+    // [0, 1) con 24 bits de mantisa
+    inline float uniform() { return (next() >> 40) * (1.0f / 16777216.0f); }
+    inline float uniform(float lo, float hi) { return lo + (hi - lo) * uniform(); }
+    inline int   range(int lo, int hi) { return lo + (int)((next() >> 32) % (uint64_t)(hi - lo + 1)); }
+    float gaussian();
+};
+
+// Llena `out` con n partículas sobre un mundo de width × height. El resultado
+// depende solo de (seed, dist, n, tamaño): no del número de hilos.
+void spawnParticles(std::vector<Particle>& out, int n, int width, int height,
+                    uint64_t seed, SpawnDist dist);
@@ -1,8 +1,7 @@
 #include "App.h"
-#include <random>
 #include <cmath>
 #include <string>
-#include <sstream>
+#include <cstdio>
 #include <algorithm>
 #include <cstring>
 #include <iostream>
@@ -18,16 +17,34 @@ App::~App() {
     SDL_Quit();
 }
 
+// Aristas por slot de --shm: el doble de los pares esperados con partículas
+// uniformes (n·λ/2, con λ vecinos por partícula), sin bajar de 8·n ni pasar
+// de los n(n-1)/2 pares posibles.
+static uint32_t defaultShmMaxEdges(int n, int worldW, int worldH, float radius) {
+    const double area     = std::max(1.0, (double)worldW * worldH);
+    const double lambda   = (n - 1.0) * 3.14159265 * radius * radius / area;
+    const double expected = 0.5 * n * lambda;
+    double m = std::max(2.0 * expected, 8.0 * n);
+    m = std::min(m, 0.5 * n * (n - 1.0));
+    m = std::min(m, (double)INT32_MAX);
+    return (uint32_t)std::max(1.0, m);
+}
+
 // Inicialización de la app
 bool App::init(const Config& cfg) {
     cfg_ = cfg;
     radius2_    = cfg_.radius * cfg_.radius;
     invRadius2_ = (radius2_ > 0.0f ? 1.0f / radius2_ : 0.0f);
-    cellSize_   = std::max(10.0f, cfg_.radius);
 
+    int arenaCount = 1;
 #ifdef USE_OPENMP
     if (cfg_.threads > 0) omp_set_num_threads(cfg_.threads);
+    arenaCount = std::max(1, omp_get_max_threads());
 #endif
+    for (int t = 0; t < arenaCount; ++t) {
+        arenas_.push_back(std::make_unique<FrameArena>());
+    }
+    if (cfg_.perfCounters) initPerfCounters();
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
         SDL_Log("SDL_Init error: %s", SDL_GetError());
@@ -53,49 +70,154 @@ bool App::init(const Config& cfg) {
     }
     SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
 
+    worldW_ = cfg_.worldW > 0 ? cfg_.worldW : cfg_.width;
+    worldH_ = cfg_.worldH > 0 ? cfg_.worldH : cfg_.height;
+    fitCamera();
+    if (cfg_.zoom > 0.f) camera_.centerOn((float)worldW_, (float)worldH_, cfg_.zoom);
+
     unsigned int seed = cfg_.seed ? cfg_.seed : (unsigned)SDL_GetTicks();
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<float> px(0.f, (float)cfg_.width);
-    std::uniform_real_distribution<float> py(0.f, (float)cfg_.height);
-    std::uniform_real_distribution<float> spd(-60.f, 60.f);
-    std::uniform_int_distribution<int> col(160,255);
-
-    particles_.resize(cfg_.n);
-    for (int i=0;i<cfg_.n;i++) {
-        particles_[i].x = px(rng);
-        particles_[i].y = py(rng);
-        particles_[i].vx = spd(rng);
-        particles_[i].vy = spd(rng);
-        particles_[i].r = (Uint8)col(rng);
-        particles_[i].g = (Uint8)col(rng);
-        particles_[i].b = (Uint8)col(rng);
-    }
-
-    gw_ = std::max(1, (int)std::ceil(cfg_.width  / cellSize_));
-    gh_ = std::max(1, (int)std::ceil(cfg_.height / cellSize_));
-    cellCounts_.assign(gw_*gh_, 0);
-    cellOffsets_.assign(gw_*gh_+1, 0);
+    spawnParticles(particles_, cfg_.n, worldW_, worldH_, seed, cfg_.dist);
+
+    if (!cfg_.shmName.empty()) {
+        const uint32_t maxEdges = cfg_.shmMaxEdges > 0
+                                ? (uint32_t)cfg_.shmMaxEdges
+                                : defaultShmMaxEdges(cfg_.n, worldW_, worldH_, cfg_.radius);
+        std::string error;
+        if (!shm_.open(cfg_.shmName, cfg_.shmSlots, (uint32_t)cfg_.n, maxEdges,
+                       (float)worldW_, (float)worldH_, error)) {
+            std::cerr << "[shm] no se pudo crear el segmento (" << error
+                      << "); se sigue sin --shm." << std::endl;
+        }
+    }
+
     cellItems_.assign(cfg_.n, 0);
+    forces_.assign(cfg_.n, NeighborAccum{});
+    configureGrid();
 
     setWindowTitle(0.f);
     return true;
 }
 
-// Título de la ventana con vista en tiempo real de parámetros
+// Estimación del costo de un frame con celdas de lado r/sub: pares candidatos
+// (densidad por celda × celdas del stencil) más el recorrido de celdas vacías.
+static double gridCost(int n, int width, int height, float radius, int sub) {
+    const float cellSize = std::max(10.0f, radius) / sub;
+    const int gw = std::max(1, (int)std::ceil(width  / cellSize));
+    const int gh = std::max(1, (int)std::ceil(height / cellSize));
+    const double cells   = (double)gw * gh;
+    const double stencil = (double)buildHalfStencil(cellSize, radius, gw).dx.size();
+    const double perCell = n / cells;
+    return n * perCell * (stencil - 0.5) + cells * stencil * 4.0;
+}
+
+// Elige la subdivisión de celdas (1..3) que minimiza gridCost para la
+// densidad actual. Con pocas partículas gana r; con muchas, r/2 o r/3.
+static int chooseCellSubdiv(int n, int width, int height, float radius) {
+    int best = 1;
+    double bestCost = gridCost(n, width, height, radius, 1);
+    for (int sub = 2; sub <= 3; ++sub) {
+        const double cost = gridCost(n, width, height, radius, sub);
+        if (cost < bestCost) { bestCost = cost; best = sub; }
+    }
+    return best;
+}
+
+// (Re)arma el grid y el stencil para el radio actual. Se llama al iniciar y
+// cada vez que cambia el radio, para que las celdas nunca queden chicas.
+void App::configureGrid() {
+    cellSubdiv_ = cfg_.cellSubdiv > 0
+                ? cfg_.cellSubdiv
+                : chooseCellSubdiv(cfg_.n, worldW_, worldH_, cfg_.radius);
+    cellSize_   = std::max(10.0f, cfg_.radius) / cellSubdiv_;
+
+    gw_ = std::max(1, (int)std::ceil(worldW_ / cellSize_));
+    gh_ = std::max(1, (int)std::ceil(worldH_ / cellSize_));
+    cellCounts_.assign(gw_*gh_, 0);
+    cellOffsets_.assign(gw_*gh_+1, 0);
+
+    stencil_ = buildHalfStencil(cellSize_, cfg_.radius, gw_);
+    gridReshaped_ = true;
+}
+
+// Con --index auto decide cada 30 frames entre grid y k-d tree mirando la
+// ocupación del grid plano: si la suma de k² por celda supera varias veces lo
+// esperado para partículas uniformes (n·(λ+1)), el grid está degenerando en
+// unas pocas celdas O(k²). Un grid con muchas más celdas que partículas
+// también se descarta. Hay histéresis para no saltar de un índice a otro.
+void App::selectSpatialIndex() {
+    // el barrido por franjas de la interacción necesita las filas del grid
+    if (cfg_.interact != InteractMode::Off) {
+        useKdTree_ = false;
+        return;
+    }
+    if (cfg_.index != IndexMode::Auto) {
+        useKdTree_ = (cfg_.index == IndexMode::KdTree);
+        return;
+    }
+    const bool firstCheck = (indexCheckFrame_ == 0);
+    if (indexCheckFrame_++ % 30 != 0) return;
+
+    const int totalCells = gw_ * gh_;
+    if (totalCells > 8 * cfg_.n) {
+        useKdTree_ = true;
+        return;
+    }
+
+    // en modo k-d el grid no se arma (y en el primer frame todavía no existe),
+    // así que se cuentan las celdas aparte
+    if (useKdTree_ || firstCheck) {
+        std::fill(cellCounts_.begin(), cellCounts_.end(), 0);
+        for (int i = 0; i < cfg_.n; ++i) {
+            int cx = static_cast<int>(particles_[i].x / cellSize_);
+            if (cx < 0) cx = 0;
+            else if (cx >= gw_) cx = gw_ - 1;
+
+            int cy = static_cast<int>(particles_[i].y / cellSize_);
+            if (cy < 0) cy = 0;
+            else if (cy >= gh_) cy = gh_ - 1;
+
+            cellCounts_[cellId(cx, cy)]++;
+        }
+    }
+
+    double sumSquares = 0.0;
+    for (int c = 0; c < totalCells; ++c) {
+        sumSquares += (double)cellCounts_[c] * cellCounts_[c];
+    }
+    const double lambda   = (double)cfg_.n / totalCells;
+    const double expected = cfg_.n * (lambda + 1.0);
+    clustering_ = sumSquares / expected;
+
+    if (!useKdTree_ && clustering_ > 4.0) useKdTree_ = true;
+    else if (useKdTree_ && clustering_ < 2.0) useKdTree_ = false;
+}
+
+// Título de la ventana con vista en tiempo real de parámetros.
+// Se arma en un buffer fijo para no reservar memoria en cada frame.
 void App::setWindowTitle(float fps) {
-    std::ostringstream oss;
-    oss << (cfg_.parallel ? "PAR" : "SEQ")
-        << " | N="   << cfg_.n
-        << " | r="   << (int)cfg_.radius
-        << " | spd=" << cfg_.speed
-        << " | C="   << (autoCycle_ ? "ON" : "OFF")
-        << " | FPS=" << (int)fps
-        << " | BG="  << (g_whiteBg ? "WHITE" : "BLACK");
-    SDL_SetWindowTitle(window_, oss.str().c_str());
+    char title[256];
+    std::snprintf(title, sizeof(title),
+        "%s%s | N=%d | r=%d | cell=r/%d | idx=%s | zoom=%.2f | spd=%.1f | C=%s | FPS=%d | BG=%s",
+        cfg_.parallel ? (cfg_.deterministic ? "PAR/DET" : "PAR") : "SEQ",
+        cfg_.interact == InteractMode::Boids ? " | BOIDS" :
+        cfg_.interact == InteractMode::Repel ? " | REPEL" : "",
+        cfg_.n, (int)cfg_.radius, cellSubdiv_, useKdTree_ ? "KD" : "GRID",
+        camera_.zoom, cfg_.speed, autoCycle_ ? "ON" : "OFF", (int)fps,
+        g_whiteBg ? "WHITE" : "BLACK");
+    SDL_SetWindowTitle(window_, title);
 
     static int frameCount = 0;
     if (++frameCount >= 30) {
-        std::cout << "FPS=" << (int)fps << std::endl;
+        std::cout << "FPS=" << (int)fps
+                  << " heap/frame=" << heapAllocsLastFrame_
+                  << " arena=" << arenaPeakBytes() / 1024 << "KB";
+        if (cfg_.verify && cfg_.parallel) {
+            std::cout << " VERIFY=" << (verifyFailures_ ? "FAIL" : "OK")
+                      << " (" << verifyFrames_ << " frames, "
+                      << verifyFailures_ << " fallos, "
+                      << edges_.size() << " aristas)";
+        }
+        std::cout << std::endl;
         frameCount = 0;
     }
 }
@@ -105,6 +227,20 @@ void App::handleEvents(bool& running) {
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
         if (e.type == SDL_QUIT) running = false;
+
+        // rueda: zoom hacia el cursor; arrastre con el botón izquierdo: pan
+        if (e.type == SDL_MOUSEWHEEL && e.wheel.y != 0) {
+            int mx = 0, my = 0;
+            SDL_GetMouseState(&mx, &my);
+            camera_.zoomAt(std::pow(1.15f, (float)e.wheel.y), mx, my);
+            camera_.clampTo((float)worldW_, (float)worldH_);
+        }
+        if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) dragging_ = true;
+        if (e.type == SDL_MOUSEBUTTONUP   && e.button.button == SDL_BUTTON_LEFT) dragging_ = false;
+        if (e.type == SDL_MOUSEMOTION && dragging_) {
+            camera_.pan(e.motion.xrel, e.motion.yrel);
+            camera_.clampTo((float)worldW_, (float)worldH_);
+        }
         if (e.type == SDL_KEYDOWN) {
             switch (e.key.keysym.sym) {
                 case SDLK_ESCAPE: running = false; break;
@@ -132,6 +268,7 @@ void App::handleEvents(bool& running) {
                     cfg_.radius += 5.f;
                     radius2_    = cfg_.radius * cfg_.radius;
                     invRadius2_ = (radius2_ > 0.0f ? 1.0f / radius2_ : 0.0f);
+                    configureGrid();
                     break;
 
                 case SDLK_DOWN:
@@ -139,12 +276,15 @@ void App::handleEvents(bool& running) {
                     if (cfg_.radius < 10.f) cfg_.radius = 10.f;
                     radius2_    = cfg_.radius * cfg_.radius;
                     invRadius2_ = (radius2_ > 0.0f ? 1.0f / radius2_ : 0.0f);
+                    configureGrid();
                     break;
 
                 case SDLK_b:
                     g_whiteBg = !g_whiteBg;
                     break;
 
+                case SDLK_h: fitCamera(); break;
+
                 default: break;
             }
         }
@@ -173,7 +313,10 @@ void App::rebuildGridSequential() {
         cellOffsets_[c + 1] = cellOffsets_[c] + cellCounts_[c];
     }
 
-    std::vector<int> curs = cellCounts_;
+    // cursores al inicio de cada celda: los índices quedan en orden ascendente,
+    // igual que en rebuildGridParallel (mismo cellItems_ en SEQ y PAR)
+    int* curs = arena(0).alloc<int>(totalCells);
+    std::copy(cellOffsets_.begin(), cellOffsets_.end() - 1, curs);
     for (int i = 0; i < cfg_.n; ++i) {
         int cx = static_cast<int>(particles_[i].x / cellSize_);
         if (cx < 0) cx = 0;
@@ -184,11 +327,11 @@ void App::rebuildGridSequential() {
         else if (cy >= gh_) cy = gh_ - 1;
 
         int id  = cellId(cx, cy);
-        int pos = cellOffsets_[id] + (--curs[id]);
-        cellItems_[pos] = i;
+        cellItems_[curs[id]++] = i;
     }
 }
 
+#ifdef USE_OPENMP
 void App::rebuildGridParallel(int maxThreads) {
     const int totalCells = gw_ * gh_;
     if (totalCells <= 0) return;
@@ -285,262 +428,551 @@ void App::rebuildGridParallel(int maxThreads) {
     }
 }
 
+// Dígitos de 8 bits para el radix sort del grid
+static constexpr int RADIX_BITS    = 8;
+static constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
 
-void App::buildEdgesSeq(float dt) {
-    const int   winW   = cfg_.width;
-    const int   winH   = cfg_.height;
-    const float r2     = radius2_;
-    const float invR2  = invRadius2_;
+// rebuildGridParallel recorre totalCells × hilos contadores por frame; con
+// grids muy finos y muchos hilos eso domina sobre N. El radix sort cuesta
+// ~2·N por pasada, así que conviene cuando celdas × hilos supera eso.
+bool App::useRadixGrid(int maxThreads) const {
+    if (cfg_.gridBuild == GridBuild::Counts) return false;
+    if (maxThreads <= 1 || cfg_.n < 2000) return false;
+    if (cfg_.gridBuild == GridBuild::Radix) return true;
 
-    for (int idx = 0; idx < cfg_.n; ++idx) {
-        auto& p = particles_[idx];
-        p.update(dt, winW, winH, cfg_.speed);
-        if (rotationSign_) {
-            const float s = std::sin(rotationSign_ * rotationSpeed_ * dt);
-            const float c = std::cos(rotationSign_ * rotationSpeed_ * dt);
-            p.rotateAroundSC(winW * 0.5f, winH * 0.5f, s, c);
-        }
-        for (int waste = 0; waste < 5; ++waste) {
-            volatile float dummy = std::sqrt(p.x * p.x + p.y * p.y);
-            dummy += std::sin(p.x * 0.01f) * std::cos(p.y * 0.01f);
-            dummy += std::exp(std::sin(waste * 0.1f));
-        }
-    }
+    const int totalCells = gw_ * gh_;
+    int passes = 0;
+    for (int bits = 0; (1LL << bits) < totalCells; bits += RADIX_BITS) ++passes;
+    return static_cast<long long>(totalCells) * maxThreads >
+           2LL * std::max(1, passes) * cfg_.n;
+}
 
-    rebuildGridSequential();
+// Grid por ordenamiento: claves (celda, partícula) con radix sort LSD
+// paralelo y estable, luego cellOffsets_ por detección de bordes entre
+// celdas. Memoria O(N + hilos × 256) en vez de O(celdas × hilos). Al ser
+// estable, cada celda queda en orden ascendente, igual que los otros builders.
+void App::rebuildGridRadix(int maxThreads) {
+    const int n          = cfg_.n;
+    const int totalCells = gw_ * gh_;
 
-    edges_.clear();
+    FrameArena& mem = arena(0);
+    int* keys     = mem.alloc<int>(n);
+    int* items    = mem.alloc<int>(n);
+    int* keysTmp  = mem.alloc<int>(n);
+    int* itemsTmp = mem.alloc<int>(n);
+    int* hist     = mem.alloc<int>(static_cast<size_t>(maxThreads) * RADIX_BUCKETS);
 
-    const int OFFSETX[5] = {0, 1, 1, 0, -1};
-    const int OFFSETY[5] = {0, 0, 1, 1,  1};
-    const int totalCells = gw_ * gh_;
+    int activeThreads = maxThreads;
 
-    for (int pass = 0; pass < 3; ++pass) {
-        volatile float warmup = 0.0f;
-        for (int cellIdFlat = 0; cellIdFlat < totalCells; ++cellIdFlat) {
-            const int cellStart = cellOffsets_[cellIdFlat];
-            const int cellEnd   = cellOffsets_[cellIdFlat + 1];
-            for (int idx = cellStart; idx < cellEnd; ++idx) {
-                const int p = cellItems_[idx];
-                warmup += std::sin(particles_[p].x * 0.001f);
-                warmup += std::cos(particles_[p].y * 0.001f);
-            }
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        const int tid = omp_get_thread_num();
+
+        #pragma omp single
+        {
+            activeThreads = omp_get_num_threads();
         }
-    }
 
-    for (int cellIdFlat = 0; cellIdFlat < totalCells; ++cellIdFlat) {
-        const int cellX = cellIdFlat % gw_;
-        const int cellY = cellIdFlat / gw_;
-        const int cellStart = cellOffsets_[cellIdFlat];
-        const int cellEnd   = cellOffsets_[cellIdFlat + 1];
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; ++i) {
+            int cx = static_cast<int>(particles_[i].x / cellSize_);
+            if (cx < 0) cx = 0;
+            else if (cx >= gw_) cx = gw_ - 1;
+
+            int cy = static_cast<int>(particles_[i].y / cellSize_);
+            if (cy < 0) cy = 0;
+            else if (cy >= gh_) cy = gh_ - 1;
 
-        for (int k = 0; k < 5; ++k) {
-            const int neighborX = cellX + OFFSETX[k];
-            const int neighborY = cellY + OFFSETY[k];
+            keys[i]  = cellId(cx, cy);
+            items[i] = i;
+        }
 
-            if (neighborX < 0 || neighborX >= gw_ ||
-                neighborY < 0 || neighborY >= gh_) {
-                continue;
+        // cada hilo siempre toma el mismo tramo contiguo: así el scatter es estable
+        const int chunk = (n + activeThreads - 1) / activeThreads;
+        const int begin = std::min(n, tid * chunk);
+        const int end   = std::min(n, begin + chunk);
+        int* localHist  = hist + static_cast<size_t>(tid) * RADIX_BUCKETS;
+
+        for (int shift = 0; (1LL << shift) < totalCells; shift += RADIX_BITS) {
+            std::fill(localHist, localHist + RADIX_BUCKETS, 0);
+            for (int i = begin; i < end; ++i) {
+                localHist[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
             }
 
-            const int neighborId    = neighborY * gw_ + neighborX;
-            const int neighborStart = cellOffsets_[neighborId];
-            const int neighborEnd   = cellOffsets_[neighborId + 1];
-
-            if (k == 0) {
-                for (int idxA = cellStart; idxA < cellEnd; ++idxA) {
-                    for (int idxB = idxA + 1; idxB < cellEnd; ++idxB) {
-                        const int pA = cellItems_[idxA];
-                        const int pB = cellItems_[idxB];
-
-                        const float dx = particles_[pA].x - particles_[pB].x;
-                        const float dy = particles_[pA].y - particles_[pB].y;
-
-                        const float d2 = dx*dx + dy*dy;
-                        const float dist = std::sqrt(d2);
-                        const float dist2 = std::sqrt(dist);
-                        const float dist3 = dist2 * dist2;
-                        const float d2_recalc = dist3 * dist;
-
-                        for (int w = 0; w < 10; ++w) {
-                            volatile float extra = std::sin(dx * 0.1f) + std::cos(dy * 0.1f);
-                            extra += std::atan2(dy, dx + 0.001f);
-                            extra += std::exp(std::sin(w * 0.01f));
-                        }
-
-                        if (d2_recalc <= r2) {
-                            edges_.push_back({ pA, pB, 1.f - d2_recalc * invR2 });
-                        }
-                    }
-                }
-            } else {
-                for (int idxA = cellStart; idxA < cellEnd; ++idxA) {
-                    const int pA = cellItems_[idxA];
-                    for (int idxB = neighborStart; idxB < neighborEnd; ++idxB) {
-                        const int pB = cellItems_[idxB];
-
-                        const float dx = particles_[pA].x - particles_[pB].x;
-                        const float dy = particles_[pA].y - particles_[pB].y;
-
-                        const float d2 = dx*dx + dy*dy;
-                        const float dist = std::sqrt(d2);
-                        const float dist2 = std::sqrt(dist);
-                        const float dist3 = dist2 * dist2;
-                        const float d2_recalc = dist3 * dist;
-
-                        for (int w = 0; w < 10; ++w) {
-                            volatile float extra = std::sin(dx * 0.1f) + std::cos(dy * 0.1f);
-                            extra += std::atan2(dy, dx + 0.001f);
-                            extra += std::exp(std::sin(w * 0.01f));
-                        }
-
-                        if (d2_recalc <= r2) {
-                            edges_.push_back({ pA, pB, 1.f - d2_recalc * invR2 });
-                        }
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // prefijo dígito-mayor, hilo-menor: posición de salida de cada tramo
+                int sum = 0;
+                for (int d = 0; d < RADIX_BUCKETS; ++d) {
+                    for (int t = 0; t < activeThreads; ++t) {
+                        int& h = hist[static_cast<size_t>(t) * RADIX_BUCKETS + d];
+                        const int count = h;
+                        h = sum;
+                        sum += count;
                     }
                 }
             }
+
+            for (int i = begin; i < end; ++i) {
+                const int pos = localHist[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                keysTmp[pos]  = keys[i];
+                itemsTmp[pos] = items[i];
+            }
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                std::swap(keys, keysTmp);
+                std::swap(items, itemsTmp);
+            }
+        }
+
+        // bordes: donde cambia la clave empiezan las celdas (prev, cur]
+        #pragma omp for schedule(static)
+        for (int i = 0; i <= n; ++i) {
+            const int prev = (i == 0) ? -1 : keys[i - 1];
+            const int cur  = (i == n) ? totalCells : keys[i];
+            for (int c = prev + 1; c <= cur; ++c) {
+                cellOffsets_[c] = i;
+            }
+            if (i < n) cellItems_[i] = items[i];
+        }
+
+        #pragma omp for schedule(static)
+        for (int c = 0; c < totalCells; ++c) {
+            cellCounts_[c] = cellOffsets_[c + 1] - cellOffsets_[c];
+        }
+    }
+}
+#endif
+
+void App::fitCamera() {
+    camera_.viewW = cfg_.width;
+    camera_.viewH = cfg_.height;
+    camera_.fit((float)worldW_, (float)worldH_);
+}
+
+// Celdas que tocan la vista ampliada en un radio: cualquier par con un extremo
+// en pantalla tiene los dos extremos ahí, así que el medio stencil lo emite
+// desde alguna de esas celdas. Con --interact las fuerzas necesitan todos los
+// pares, con --shm los lectores reciben el grafo entero y con el k-d tree no
+// hay filas de celdas: en esos casos no se recorta.
+void App::updateVisibleCells() {
+    camera_.visibleRect(cfg_.radius, viewX0_, viewY0_, viewX1_, viewY1_);
+    cullEdges_ = !camera_.coversWorld((float)worldW_, (float)worldH_) &&
+                 !useKdTree_ && cfg_.interact == InteractMode::Off && !shm_.isOpen();
+    if (!cullEdges_) {
+        visibleCells_ = CellRect{ 0, 0, gw_, gh_ };
+        return;
+    }
+
+    auto toCell = [](float w, float size, int count) {
+        const int c = static_cast<int>(std::floor(w / size));
+        return c < 0 ? 0 : (c >= count ? count - 1 : c);
+    };
+    const int cx0 = toCell(viewX0_, cellSize_, gw_), cx1 = toCell(viewX1_, cellSize_, gw_);
+    const int cy0 = toCell(viewY0_, cellSize_, gh_), cy1 = toCell(viewY1_, cellSize_, gh_);
+    visibleCells_ = CellRect{ cx0, cy0, cx1 - cx0 + 1, cy1 - cy0 + 1 };
+}
+
+// En pausa no se integra, pero si la cámara pasó a otras celdas (o el radio
+// cambió el grid) el índice y las aristas se rearman para la vista nueva con
+// las mismas posiciones.
+void App::refreshPausedView() {
+    const CellRect before = visibleCells_;
+    updateVisibleCells();
+    const CellRect& vc = visibleCells_;
+    if (!gridReshaped_ && vc.cx0 == before.cx0 && vc.cy0 == before.cy0 &&
+        vc.cols == before.cols && vc.rows == before.rows) return;
+
+    if (cfg_.parallel) buildEdgesPar(0.f, false);
+    else               buildEdgesSeq(0.f, false);
+}
+
+App::StepParams App::stepParams(float dt) const {
+    StepParams sp;
+    sp.rate  = camera_.coversWorld((float)worldW_, (float)worldH_) ? 1 : cfg_.offscreenRate;
+    sp.phase = (int)(simFrame_ % sp.rate);
+    sp.dt     = dt;
+    sp.dtSlow = dt * sp.rate;
+
+    const float angle = rotationSign_ * rotationSpeed_ * dt;
+    sp.s     = rotationSign_ ? std::sin(angle) : 0.f;
+    sp.c     = rotationSign_ ? std::cos(angle) : 1.f;
+    sp.sSlow = rotationSign_ ? std::sin(angle * sp.rate) : 0.f;
+    sp.cSlow = rotationSign_ ? std::cos(angle * sp.rate) : 1.f;
+    return sp;
+}
+
+// Las partículas fuera de la vista avanzan escalonadas por índice (i + frame)
+// para que cada frame integre más o menos la misma cantidad.
+inline void App::stepParticle(int i, const StepParams& sp) {
+    Particle& p = particles_[i];
+    float dt = sp.dt, s = sp.s, c = sp.c;
+    if (sp.rate > 1 &&
+        (p.x < viewX0_ || p.x >= viewX1_ || p.y < viewY0_ || p.y >= viewY1_)) {
+        if ((sp.phase + i) % sp.rate != 0) return;
+        dt = sp.dtSlow; s = sp.sSlow; c = sp.cSlow;
+    }
+
+    if (cfg_.interact != InteractMode::Off) {
+        applyInteraction(p, forces_[i], cfg_.interact, dt);
+    }
+    p.update(dt, worldW_, worldH_, cfg_.speed);
+    if (rotationSign_) {
+        p.rotateAroundSC(worldW_ * 0.5f, worldH_ * 0.5f, s, c);
+    }
+}
+
+void App::buildEdgesSeq(float dt, bool integrate) {
+    const StepParams sp = stepParams(dt);
+    const InteractMode interact = cfg_.interact;
+
+    perf_.mark(PerfPhase::Integrate);
+    if (integrate) {
+        for (int i = 0; i < cfg_.n; ++i) {
+            stepParticle(i, sp);
         }
     }
+
+    perf_.mark(PerfPhase::Grid);
+    if (useKdTree_) kdTree_.build(particles_, 1);
+    else            rebuildGridSequential();
+    gridReshaped_ = false;
+
+    perf_.mark(PerfPhase::Edges);
+    NeighborAccum* forces = nullptr;
+    if (interact != InteractMode::Off) {
+        std::fill(forces_.begin(), forces_.end(), NeighborAccum{});
+        forces = forces_.data();
+    }
+    collectEdgesSeq(edges_, forces);
+    perf_.mark(PerfPhase::None);
+    if (perf_.enabled()) perfPairs_ += candidatePairs();
+}
+
+GridView App::gridView() const {
+    return GridView{ particles_.data(), cellOffsets_.data(), cellItems_.data(),
+                     gw_, gh_, radius2_, invRadius2_,
+                     stencil_.dx.data(), stencil_.dy.data(), stencil_.delta.data(),
+                     (int)stencil_.dx.size(), stencil_.reach };
 }
 
-void App::buildEdgesPar(float dt) {
+// Los pesos solo los consume el render, la interacción, --verify y --shm
+bool App::edgeWeightsNeeded() const {
+    return !cfg_.bench || cfg_.verify || cfg_.interact != InteractMode::Off ||
+           shm_.isOpen();
+}
+
+// Una unidad de trabajo (celda del grid u hoja del k-d tree) hacia `sink`.
+template <class Sink>
+static void emitUnit(const GridView& g, const KdView& kv, bool useKd,
+                     bool withWeights, int unit, Sink& sink) {
+    if (useKd) {
+        if (withWeights) kdLeafEdges<true>(kv, unit, sink);
+        else             kdLeafEdges<false>(kv, unit, sink);
+    } else {
+        if (withWeights) edgeCellDispatch<true>(g, unit, sink);
+        else             edgeCellDispatch<false>(g, unit, sink);
+    }
+}
+
+// Elige el destino según haya o no fuerzas que acumular y llama a
+// fn(sink). Así SEQ y PAR arman exactamente los mismos destinos.
+template <class Vec, class Fn>
+static void withEdgeSink(Vec& out, NeighborAccum* forces, InteractMode mode,
+                         const Particle* ps, float sepR2, Fn&& fn) {
+    if (forces && mode == InteractMode::Boids) {
+        InteractionSink<InteractMode::Boids, Vec> sink{ out, forces, ps, sepR2 };
+        fn(sink);
+    } else if (forces && mode == InteractMode::Repel) {
+        InteractionSink<InteractMode::Repel, Vec> sink{ out, forces, ps, sepR2 };
+        fn(sink);
+    } else {
+        EdgeVectorSink<Vec> sink{ out };
+        fn(sink);
+    }
+}
+
+// Recorre el índice ya construido y deja en `out` las aristas en orden
+// canónico: celda por celda (u hoja por hoja en el k-d tree), la unidad
+// misma primero y luego sus vecinas. Con `forces` suma además la interacción.
+// Con la cámara acercada solo se recorren las celdas de `visibleCells_`.
+void App::collectEdgesSeq(std::vector<Edge>& out, NeighborAccum* forces) {
+    out.clear();
+
+    const GridView g  = gridView();
+    const KdView   kv = kdTree_.view(particles_.data(), radius2_, invRadius2_);
+    const bool useKd       = useKdTree_;
+    const bool withWeights = edgeWeightsNeeded();
+    const CellRect vc      = visibleCells_;
+    const int  numUnits    = useKd ? kdTree_.leafCount() : vc.count();
+
+    withEdgeSink(out, forces, cfg_.interact, particles_.data(), radius2_ * 0.25f,
+        [&](auto& sink) {
+            for (int unit = 0; unit < numUnits; ++unit) {
+                emitUnit(g, kv, useKd, withWeights, useKd ? unit : vc.cell(unit, gw_), sink);
+            }
+        });
+}
+
+void App::buildEdgesPar(float dt, bool integrate) {
 #ifndef USE_OPENMP
-    buildEdgesSeq(dt);
+    buildEdgesSeq(dt, integrate);
     return;
 #else
-    const int   winW   = cfg_.width;
-    const int   winH   = cfg_.height;
-    const float r2     = radius2_;
-    const float invR2  = invRadius2_;
-    const float s      = (rotationSign_ ? std::sin(rotationSign_ * rotationSpeed_ * dt) : 0.f);
-    const float c      = (rotationSign_ ? std::cos(rotationSign_ * rotationSpeed_ * dt) : 1.f);
-
+    const StepParams sp = stepParams(dt);
     const int totalCells = gw_ * gh_;
 
     int maxThreads = std::max(1, omp_get_max_threads());
     if (cfg_.threads > 0 && cfg_.threads < maxThreads)
         maxThreads = cfg_.threads;
 
-    if (maxThreads > totalCells)
+    if (!useKdTree_ && maxThreads > totalCells)
         maxThreads = totalCells;
 
-    #pragma omp parallel for schedule(static) num_threads(maxThreads)
-    for (int i = 0; i < cfg_.n; ++i) {
-        particles_[i].update(dt, winW, winH, cfg_.speed);
-        if (rotationSign_) {
-            particles_[i].rotateAroundSC(winW * 0.5f, winH * 0.5f, s, c);
+    const InteractMode interact = cfg_.interact;
+
+    perf_.mark(PerfPhase::Integrate);
+    if (integrate) {
+        #pragma omp parallel for schedule(static) num_threads(maxThreads)
+        for (int i = 0; i < cfg_.n; ++i) {
+            stepParticle(i, sp);
         }
     }
 
-    rebuildGridParallel(maxThreads);
+    perf_.mark(PerfPhase::Grid);
+    radixGrid_ = !useKdTree_ && useRadixGrid(maxThreads);
+    if (useKdTree_)      kdTree_.build(particles_, maxThreads);
+    else if (radixGrid_) rebuildGridRadix(maxThreads);
+    else                 rebuildGridParallel(maxThreads);
+    gridReshaped_ = false;
+
+    perf_.mark(PerfPhase::Edges);
+    NeighborAccum* forces = nullptr;
+    if (interact != InteractMode::Off) {
+        #pragma omp parallel for schedule(static) num_threads(maxThreads)
+        for (int i = 0; i < cfg_.n; ++i) forces_[i] = NeighborAccum{};
+        forces = forces_.data();
+    }
+    collectEdgesPar(edges_, maxThreads, forces);
+    perf_.mark(PerfPhase::None);
+    if (perf_.enabled()) perfPairs_ += candidatePairs();
 
-    static std::vector<std::vector<Edge>> threadEdges;
-    if ((int)threadEdges.size() != maxThreads) {
-        threadEdges.assign(maxThreads, std::vector<Edge>());
+    if (cfg_.verify) verifyAgainstSeq();
+#endif
+}
+
+#ifdef USE_OPENMP
+// Celdas (u hojas) por bloque en modo determinista. Es fijo (no depende de los hilos)
+// para que el orden de salida sea siempre el mismo.
+static constexpr int DET_BLOCK_CELLS = 32;
+
+void App::collectEdgesPar(std::vector<Edge>& out, int maxThreads, NeighborAccum* forces) {
+    // unidades de trabajo: celdas visibles del grid u hojas del k-d tree
+    const CellRect vc  = visibleCells_;
+    const int numUnits = useKdTree_ ? kdTree_.leafCount() : vc.count();
+
+    // bolsitas por hilo sobre la arena de cada hilo; se re-siembran cada frame
+    if ((int)threadEdges_.size() < maxThreads) {
+        threadEdges_.resize(maxThreads);
     }
 
-    const size_t approxEdges    = static_cast<size_t>(cfg_.n) * 8;
+    // la reserva sigue a lo que dejó el frame anterior para no crecer a saltos
+    const size_t approxEdges    = std::max(static_cast<size_t>(cfg_.n) * 8, out.size());
     const size_t perThreadReserve =
-        approxEdges / static_cast<size_t>(maxThreads) + 256;
-
-    for (int t = 0; t < maxThreads; ++t) {
-        if (threadEdges[t].capacity() < perThreadReserve) {
-            threadEdges[t].reserve(perThreadReserve);
-        }
+        approxEdges / static_cast<size_t>(maxThreads) * 5 / 4 + 256;
+
+    // Con fuerzas, cada par escribe en sus dos partículas y el stencil baja
+    // hasta `reach` filas. Los bloques pasan a ser franjas de reach+1 filas y
+    // se recorren en dos fases (pares, luego impares): dos franjas de la misma
+    // fase quedan separadas por una franja entera y nunca escriben la misma
+    // partícula. El orden de suma tampoco depende de los hilos.
+    const bool banded    = (forces != nullptr);
+    const int  bandRows  = stencil_.reach + 1;
+    const int  blockSize = banded ? bandRows * vc.cols : DET_BLOCK_CELLS;
+    const int  numBlocks = (numUnits + blockSize - 1) / blockSize;
+    const bool perBlock  = cfg_.deterministic || banded;
+    if (perBlock) {
+        detBlockThread_.resize(numBlocks);
+        detBlockStart_.resize(numBlocks);
+        detBlockOffset_.resize(numBlocks + 1);
     }
 
-    const int OFFSETX[5] = {0, 1, 1, 0, -1};
-    const int OFFSETY[5] = {0, 0, 1, 1,  1};
-    const Particle* particlesPtr = particles_.data();
+    const GridView g  = gridView();
+    const KdView   kv = kdTree_.view(particles_.data(), radius2_, invRadius2_);
+    const bool useKd       = useKdTree_;
+    const bool withWeights = edgeWeightsNeeded();
+
+    const InteractMode interact = cfg_.interact;
+    const Particle* ps = particles_.data();
+    const float sepR2 = radius2_ * 0.25f;
+
+    // mismos destinos e instanciaciones de kernel que SEQ; solo cambia quién
+    // recorre las unidades
+    auto processUnits = [&](int firstUnit, int lastUnit, ArenaVector<Edge>& localEdges) {
+        withEdgeSink(localEdges, forces, interact, ps, sepR2, [&](auto& sink) {
+            for (int unit = firstUnit; unit < lastUnit; ++unit) {
+                emitUnit(g, kv, useKd, withWeights, useKd ? unit : vc.cell(unit, gw_), sink);
+            }
+        });
+    };
 
     int activeThreads = maxThreads;
 
     #pragma omp parallel num_threads(maxThreads)
     {
         const int tid = omp_get_thread_num();
-        auto& localEdges = threadEdges[tid];
-        localEdges.clear();
-
-        const int totalCellsLocal = gw_ * gh_;
+        auto& localEdges = threadEdges_[tid];
+        localEdges = ArenaVector<Edge>(ArenaAllocator<Edge>(&arena(tid)));
+        localEdges.reserve(perThreadReserve);
 
         #pragma omp single
         {
             activeThreads = omp_get_num_threads();
         }
 
-        #pragma omp for schedule(guided, 8)
-        for (int cellIdFlat = 0; cellIdFlat < totalCellsLocal; ++cellIdFlat) {
-            const int cellX = cellIdFlat % gw_;
-            const int cellY = cellIdFlat / gw_;
-            const int cellStart = cellOffsets_[cellIdFlat];
-            const int cellEnd   = cellOffsets_[cellIdFlat + 1];
+        if (perBlock) {
+            // cada bloque anota en qué bolsita quedó y dónde empieza
+            const int phases = banded ? 2 : 1;
+            for (int phase = 0; phase < phases; ++phase) {
+                const int phaseBlocks = (numBlocks - phase + phases - 1) / phases;
+
+                #pragma omp for schedule(dynamic, 1)
+                for (int j = 0; j < phaseBlocks; ++j) {
+                    const int block     = phase + j * phases;
+                    const int firstUnit = block * blockSize;
+                    const int lastUnit  = std::min(numUnits, firstUnit + blockSize);
+                    const size_t start  = localEdges.size();
 
-            for (int k = 0; k < 5; ++k) {
-                const int neighborX = cellX + OFFSETX[k];
-                const int neighborY = cellY + OFFSETY[k];
+                    processUnits(firstUnit, lastUnit, localEdges);
 
-                if (neighborX < 0 || neighborX >= gw_ ||
-                    neighborY < 0 || neighborY >= gh_) {
-                    continue;
+                    detBlockThread_[block]     = tid;
+                    detBlockStart_[block]      = start;
+                    detBlockOffset_[block + 1] = localEdges.size() - start;
                 }
+            }
+        } else {
+            #pragma omp for schedule(guided, 8)
+            for (int unit = 0; unit < numUnits; ++unit) {
+                processUnits(unit, unit + 1, localEdges);
+            }
+        }
+    }
 
-                const int neighborId    = neighborY * gw_ + neighborX;
-                const int neighborStart = cellOffsets_[neighborId];
-                const int neighborEnd   = cellOffsets_[neighborId + 1];
+    perf_.mark(PerfPhase::Merge);
 
-                if (k == 0) {
-                    for (int idxA = cellStart; idxA < cellEnd; ++idxA) {
-                        for (int idxB = idxA + 1; idxB < cellEnd; ++idxB) {
-                            const int pA = cellItems_[idxA];
-                            const int pB = cellItems_[idxB];
+    if (perBlock) {
+        // prefijo sobre los conteos por bloque -> rango de salida de cada bloque
+        detBlockOffset_[0] = 0;
+        for (int block = 0; block < numBlocks; ++block) {
+            detBlockOffset_[block + 1] += detBlockOffset_[block];
+        }
 
-                            const float dx = particlesPtr[pA].x - particlesPtr[pB].x;
-                            const float dy = particlesPtr[pA].y - particlesPtr[pB].y;
-                            const float d2 = dx*dx + dy*dy;
+        out.resize(detBlockOffset_[numBlocks]);
 
-                            if (d2 <= r2) {
-                                localEdges.push_back({ pA, pB, 1.f - d2 * invR2 });
-                            }
-                        }
-                    }
-                } else {
-                    for (int idxA = cellStart; idxA < cellEnd; ++idxA) {
-                        const int pA = cellItems_[idxA];
-                        for (int idxB = neighborStart; idxB < neighborEnd; ++idxB) {
-                            const int pB = cellItems_[idxB];
-
-                            const float dx = particlesPtr[pA].x - particlesPtr[pB].x;
-                            const float dy = particlesPtr[pA].y - particlesPtr[pB].y;
-                            const float d2 = dx*dx + dy*dy;
-
-                            if (d2 <= r2) {
-                                localEdges.push_back({ pA, pB, 1.f - d2 * invR2 });
-                            }
-                        }
-                    }
-                }
-            }
+        // colocación en paralelo: cada bloque copia su tramo a su rango final
+        #pragma omp parallel for schedule(dynamic, 4) num_threads(activeThreads)
+        for (int block = 0; block < numBlocks; ++block) {
+            const auto& src   = threadEdges_[detBlockThread_[block]];
+            const size_t from = detBlockStart_[block];
+            const size_t count = detBlockOffset_[block + 1] - detBlockOffset_[block];
+            std::copy(src.begin() + from, src.begin() + from + count,
+                      out.begin() + detBlockOffset_[block]);
         }
+        return;
     }
 
     size_t totalSize = 0;
     for (int t = 0; t < activeThreads; ++t) {
-        totalSize += threadEdges[t].size();
+        totalSize += threadEdges_[t].size();
     }
 
-    edges_.resize(totalSize);
+    out.resize(totalSize);
     size_t offset = 0;
     for (int t = 0; t < activeThreads; ++t) {
-        auto& vec = threadEdges[t];
+        auto& vec = threadEdges_[t];
         if (!vec.empty()) {
-            std::copy(vec.begin(), vec.end(), edges_.begin() + offset);
+            std::copy(vec.begin(), vec.end(), out.begin() + offset);
             offset += vec.size();
         }
     }
-#endif
 }
 
+// --verify: recalcula el grid y las aristas con el camino SEQ sobre las mismas
+// posiciones y compara contra lo que produjo PAR en este frame.
+void App::verifyAgainstSeq() {
+    bool sameGrid = false;
+    if (useKdTree_) {
+        verifyGrid_ = kdTree_.items();
+        kdTree_.build(particles_, 1);
+        sameGrid = (verifyGrid_ == kdTree_.items());
+    } else {
+        verifyGrid_ = cellItems_;
+        rebuildGridSequential();
+        sameGrid = (verifyGrid_ == cellItems_);
+    }
+
+    // con --interact también se comparan las fuerzas; el orden de suma de
+    // SEQ (celda por celda) y de PAR (por franjas) difiere, así que con tolerancia
+    size_t badForces = 0;
+    if (cfg_.interact != InteractMode::Off) {
+        verifyForces_.assign(cfg_.n, NeighborAccum{});
+        collectEdgesSeq(verifySeqEdges_, verifyForces_.data());
+        auto close = [](float x, float y) {
+            return std::fabs(x - y) <= 1e-3f * (1.f + std::fabs(x));
+        };
+        for (int i = 0; i < cfg_.n; ++i) {
+            const NeighborAccum& fs = verifyForces_[i];
+            const NeighborAccum& fp = forces_[i];
+            if (!close(fs.sepX, fp.sepX) || !close(fs.sepY, fp.sepY) ||
+                !close(fs.velX, fp.velX) || !close(fs.velY, fp.velY) ||
+                !close(fs.offX, fp.offX) || !close(fs.offY, fp.offY) ||
+                fs.count != fp.count) {
+                ++badForces;
+            }
+        }
+    } else {
+        collectEdgesSeq(verifySeqEdges_, nullptr);
+    }
+    verifyParEdges_ = edges_;
+
+    // sin --det el orden depende de los hilos: se compara como conjunto
+    if (!cfg_.deterministic) {
+        auto byPair = [](const Edge& l, const Edge& r) {
+            return l.a != r.a ? l.a < r.a : l.b < r.b;
+        };
+        std::sort(verifySeqEdges_.begin(), verifySeqEdges_.end(), byPair);
+        std::sort(verifyParEdges_.begin(), verifyParEdges_.end(), byPair);
+    }
+
+    size_t mismatch = std::min(verifySeqEdges_.size(), verifyParEdges_.size());
+    for (size_t i = 0; i < mismatch; ++i) {
+        const Edge& es = verifySeqEdges_[i];
+        const Edge& ep = verifyParEdges_[i];
+        if (es.a != ep.a || es.b != ep.b || es.w != ep.w) {
+            mismatch = i;
+            break;
+        }
+    }
+
+    ++verifyFrames_;
+    if (sameGrid && badForces == 0 && mismatch == verifySeqEdges_.size() &&
+        verifySeqEdges_.size() == verifyParEdges_.size()) {
+        return;
+    }
+
+    ++verifyFailures_;
+    std::cerr << "[verify] frame " << verifyFrames_ << ": PAR != SEQ"
+              << " (" << (useKdTree_ ? "k-d tree " : "grid ") << (sameGrid ? "ok" : "distinto")
+              << ", aristas SEQ=" << verifySeqEdges_.size()
+              << " PAR=" << verifyParEdges_.size()
+              << ", primera diferencia en " << mismatch
+              << ", fuerzas distintas " << badForces << ")" << std::endl;
+}
+#endif
+
 
 
 void App::update(float dt) {
@@ -558,6 +990,11 @@ void App::update(float dt) {
     if (globalAngle_ > 6.28318f)  globalAngle_ -= 6.28318f;
     if (globalAngle_ < -6.28318f) globalAngle_ += 6.28318f;
 
+    selectSpatialIndex();
+    updateVisibleCells();
+    ++simFrame_;
+    simTime_ += dt;
+
     if (cfg_.parallel) buildEdgesPar(dt);
     else               buildEdgesSeq(dt);
 
@@ -566,51 +1003,75 @@ void App::update(float dt) {
 
 void App::render() {
     if (cfg_.bench) return;
+    perf_.mark(PerfPhase::Render);
 
     if (g_whiteBg) SDL_SetRenderDrawColor(renderer_, 245, 245, 247, 255);
     else           SDL_SetRenderDrawColor(renderer_,  10,  10,  12, 255);
     SDL_RenderClear(renderer_);
 
+    // todo se dibuja a través de la cámara; lo que cae fuera de la ventana
+    // o en un mismo píxel no genera llamadas de dibujo
+    const Camera cam = camera_;
+    const float viewW = (float)cam.viewW, viewH = (float)cam.viewH;
+
     const size_t numEdges = edges_.size();
     if (numEdges > 0) {
         constexpr int NUM_BUCKETS = 8;
         struct EdgeLine {
             int x1, y1, x2, y2;
         };
-        static std::vector<EdgeLine> bucketLines[NUM_BUCKETS];
 
-        static bool bucketsInitialized = false;
-        if (!bucketsInitialized) {
-            for (int i = 0; i < NUM_BUCKETS; ++i) {
-                bucketLines[i].reserve(4000);
+        const Particle* __restrict__ particlesPtr = particles_.data();
+        const Edge* __restrict__ edgesPtr = edges_.data();
+
+        auto bucketOf = [](float w) {
+            int bucket = static_cast<int>(w * NUM_BUCKETS);
+            return bucket >= NUM_BUCKETS ? NUM_BUCKETS - 1 : bucket;
+        };
+
+        // conteo por balde (-1 = no se dibuja) y luego un solo arreglo en la
+        // arena, del tamaño justo
+        int8_t* edgeBucket = arena(0).alloc<int8_t>(numEdges);
+        size_t bucketStart[NUM_BUCKETS + 1] = {};
+        for (size_t i = 0; i < numEdges; ++i) {
+            const Edge& e = edgesPtr[i];
+            const Particle& a = particlesPtr[e.a];
+            const Particle& b = particlesPtr[e.b];
+            const float ax = cam.toScreenX(a.x), ay = cam.toScreenY(a.y);
+            const float bx = cam.toScreenX(b.x), by = cam.toScreenY(b.y);
+
+            const bool offScreen = std::max(ax, bx) < 0.f || std::min(ax, bx) >= viewW ||
+                                   std::max(ay, by) < 0.f || std::min(ay, by) >= viewH;
+            const bool subPixel  = (int)ax == (int)bx && (int)ay == (int)by;
+            if (offScreen || subPixel) {
+                edgeBucket[i] = -1;
+                continue;
             }
-            bucketsInitialized = true;
+            edgeBucket[i] = (int8_t)bucketOf(e.w);
+            bucketStart[edgeBucket[i] + 1]++;
         }
-
         for (int i = 0; i < NUM_BUCKETS; ++i) {
-            bucketLines[i].clear();
+            bucketStart[i + 1] += bucketStart[i];
         }
 
-        const Particle* __restrict__ particlesPtr = particles_.data();
-        const Edge* __restrict__ edgesPtr = edges_.data();
+        EdgeLine* allLines = arena(0).alloc<EdgeLine>(bucketStart[NUM_BUCKETS]);
+        size_t bucketFill[NUM_BUCKETS];
+        std::copy(bucketStart, bucketStart + NUM_BUCKETS, bucketFill);
 
         for (size_t i = 0; i < numEdges; ++i) {
+            if (edgeBucket[i] < 0) continue;
             const Edge& e = edgesPtr[i];
             const Particle& a = particlesPtr[e.a];
             const Particle& b = particlesPtr[e.b];
 
-            int bucket = static_cast<int>(e.w * NUM_BUCKETS);
-            if (bucket >= NUM_BUCKETS) bucket = NUM_BUCKETS - 1;
-
-            bucketLines[bucket].push_back({
-                static_cast<int>(a.x), static_cast<int>(a.y),
-                static_cast<int>(b.x), static_cast<int>(b.y)
-            });
+            allLines[bucketFill[edgeBucket[i]]++] = {
+                static_cast<int>(cam.toScreenX(a.x)), static_cast<int>(cam.toScreenY(a.y)),
+                static_cast<int>(cam.toScreenX(b.x)), static_cast<int>(cam.toScreenY(b.y))
+            };
         }
 
         for (int i = 0; i < NUM_BUCKETS; ++i) {
-            const std::vector<EdgeLine>& lines = bucketLines[i];
-            const size_t lineCount = lines.size();
+            const size_t lineCount = bucketStart[i + 1] - bucketStart[i];
             if (lineCount == 0) continue;
 
             const float w = (i + 0.5f) / NUM_BUCKETS;
@@ -619,7 +1080,7 @@ void App::render() {
 
             SDL_SetRenderDrawColor(renderer_, c.r, c.g, c.b, alpha);
 
-            const EdgeLine* __restrict__ linesPtr = lines.data();
+            const EdgeLine* __restrict__ linesPtr = allLines + bucketStart[i];
             for (size_t j = 0; j < lineCount; ++j) {
                 const EdgeLine& line = linesPtr[j];
                 SDL_RenderDrawLine(renderer_, line.x1, line.y1, line.x2, line.y2);
@@ -627,21 +1088,231 @@ void App::render() {
         }
     }
 
-    for (const auto& p : particles_) {
+    // puntos: de lejos se achican para no tapar todo
+    const int dot  = cam.zoom >= 1.f ? 3 : (cam.zoom >= 0.5f ? 2 : 1);
+    const int half = dot / 2;
+    auto drawParticle = [&](const Particle& p) {
+        const float sx = cam.toScreenX(p.x), sy = cam.toScreenY(p.y);
+        if (sx < 0.f || sx >= viewW || sy < 0.f || sy >= viewH) return;
         SDL_SetRenderDrawColor(renderer_, p.r, p.g, p.b, 220);
-        SDL_Rect r{ (int)p.x-1, (int)p.y-1, 3, 3 };
+        SDL_Rect r{ (int)sx - half, (int)sy - half, dot, dot };
         SDL_RenderFillRect(renderer_, &r);
+    };
+
+    if (useKdTree_ || !cullEdges_) {
+        for (const auto& p : particles_) drawParticle(p);
+    } else {
+        // con el grid, solo las celdas que tocan la ventana
+        float x0, y0, x1, y1;
+        cam.visibleRect(0.f, x0, y0, x1, y1);
+        const int cx0 = std::max(0, (int)std::floor(x0 / cellSize_));
+        const int cy0 = std::max(0, (int)std::floor(y0 / cellSize_));
+        const int cx1 = std::min(gw_ - 1, (int)std::floor(x1 / cellSize_));
+        const int cy1 = std::min(gh_ - 1, (int)std::floor(y1 / cellSize_));
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const int c = cellId(cx, cy);
+                for (int k = cellOffsets_[c]; k < cellOffsets_[c + 1]; ++k) {
+                    drawParticle(particles_[cellItems_[k]]);
+                }
+            }
+        }
     }
 
     SDL_RenderPresent(renderer_);
+    perf_.mark(PerfPhase::None);
+}
+
+// Al inicio de cada frame se vacían las arenas y se toma el contador de
+// reservas del heap; endFrame guarda cuántas hubo en el frame.
+void App::beginFrame() {
+    for (auto& a : arenas_) a->reset();
+    frameHeapStart_ = heapAllocationCount();
+}
+
+void App::endFrame() {
+    heapAllocsLastFrame_ = heapAllocationCount() - frameHeapStart_;
+}
+
+size_t App::arenaPeakBytes() const {
+    size_t total = 0;
+    for (const auto& a : arenas_) total += a->highWater();
+    return total;
+}
+
+// Resumen de una corrida con --frames, en formato clave=valor para que lo
+// lean los scripts de barrido (tools/sweep.py).
+void App::printRunSummary() const {
+    int threads = 1;
+#ifdef USE_OPENMP
+    if (cfg_.parallel) threads = std::max(1, omp_get_max_threads());
+#endif
+    const double frames = std::max(1L, runStats_.frames);
+    std::cout << "RESULT"
+              << " mode="      << (cfg_.parallel ? "PAR" : "SEQ")
+              << " threads="   << threads
+              << " n="         << cfg_.n
+              << " r="         << cfg_.radius
+              << " world="     << worldW_ << "x" << worldH_
+              << " zoom="      << camera_.zoom
+              << " cells="     << cellSubdiv_
+              << " index="     << (useKdTree_ ? "KD" : (radixGrid_ ? "GRID/RADIX" : "GRID"))
+              << " frames="    << runStats_.frames
+              << " update_ms=" << runStats_.updateSec * 1000.0 / frames
+              << " render_ms=" << runStats_.renderSec * 1000.0 / frames
+              << " publish_ms=" << runStats_.publishSec * 1000.0 / frames
+              << " edges="     << (long)(runStats_.edges / frames)
+              << " heap_per_frame=" << heapAllocsLastFrame_
+              << " arena_kb="  << arenaPeakBytes() / 1024;
+    if (cfg_.verify && cfg_.parallel) {
+        std::cout << " verify="   << (verifyFailures_ ? "FAIL" : (verifyFrames_ ? "OK" : "SKIP"))
+                  << " verify_frames="   << verifyFrames_
+                  << " verify_failures=" << verifyFailures_;
+    }
+    std::cout << std::endl;
+}
+
+// --perf-counters: cada hilo del equipo abre su propio grupo de contadores.
+// Los hilos de OpenMP se reutilizan entre regiones, así que los grupos
+// abiertos acá siguen midiendo a los mismos hilos el resto de la corrida.
+void App::initPerfCounters() {
+    bool ok = true;
+#ifdef USE_OPENMP
+    const int team = (int)arenas_.size();
+    #pragma omp parallel num_threads(team) reduction(&&:ok)
+    {
+        bool opened = false;
+        #pragma omp critical(perf_open)
+        opened = perf_.openForThread(omp_get_thread_num());
+        ok = ok && opened;
+    }
+#else
+    ok = perf_.openForThread(0);
+#endif
+    perf_.setEnabled(ok);
+    if (!ok) {
+        std::cerr << "[perf] contadores no disponibles (" << perf_.error()
+                  << "); se sigue sin --perf-counters."
+                  << " Revisar /proc/sys/kernel/perf_event_paranoid" << std::endl;
+    }
+}
+
+// Pares que revisa el barrido del grid en un frame: cada celda (visible) contra
+// sí misma y contra las vecinas del medio stencil. Con k-d tree no se cuenta (0).
+double App::candidatePairs() const {
+    if (useKdTree_) return 0.0;
+
+    double pairs = 0.0;
+    const int ns = (int)stencil_.dx.size();
+    const CellRect vc = visibleCells_;
+    for (int cy = vc.cy0; cy < vc.cy0 + vc.rows; ++cy) {
+        for (int cx = vc.cx0; cx < vc.cx0 + vc.cols; ++cx) {
+            const double k = cellCounts_[cellId(cx, cy)];
+            if (k == 0) continue;
+            for (int s = 0; s < ns; ++s) {
+                const int nx = cx + stencil_.dx[s];
+                const int ny = cy + stencil_.dy[s];
+                if (nx < 0 || nx >= gw_ || ny >= gh_) continue;
+                if (nx == cx && ny == cy) pairs += k * (k - 1) * 0.5;
+                else                      pairs += k * cellCounts_[cellId(nx, ny)];
+            }
+        }
+    }
+    return pairs;
 }
 
-void App::run() {
+// --shm: copia el frame a su slot del anillo pasando de AoS a SoA. Si hay
+// más aristas que lugar, van las primeras y numEdgesTotal avisa del corte.
+void App::publishFrame() {
+    perf_.mark(PerfPhase::Publish);
+    ShmFrame f = shm_.begin(++shmFrame_, simTime_);
+
+    const int n = cfg_.n;
+    const int m = (int)std::min<size_t>(edges_.size(), shm_.maxEdges());
+    const Particle* ps = particles_.data();
+    const Edge*     es = edges_.data();
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(static) if(cfg_.parallel)
+#endif
+    for (int i = 0; i < n; ++i) {
+        f.x[i]  = ps[i].x;   f.y[i]  = ps[i].y;
+        f.vx[i] = ps[i].vx;  f.vy[i] = ps[i].vy;
+        f.r[i]  = ps[i].r;   f.g[i]  = ps[i].g;   f.b[i] = ps[i].b;
+    }
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(static) if(cfg_.parallel)
+#endif
+    for (int k = 0; k < m; ++k) {
+        f.edgeA[k] = es[k].a;
+        f.edgeB[k] = es[k].b;
+        f.edgeW[k] = es[k].w;
+    }
+
+    shm_.commit(f, (uint32_t)n, (uint32_t)m, (uint32_t)edges_.size());
+    if ((size_t)m < edges_.size() && !shmCutWarned_) {
+        shmCutWarned_ = true;
+        std::cerr << "[shm] frame " << shmFrame_ << ": " << edges_.size()
+                  << " aristas y lugar para " << m << "; se publican las primeras."
+                  << " Subir --shm-max-edges." << std::endl;
+    }
+    perf_.mark(PerfPhase::None);
+}
+
+void App::reportPerf() {
+    const double pairsPerFrame = perfFrames_ > 0 ? perfPairs_ / perfFrames_ : 0.0;
+    perf_.report(std::cout, (double)cfg_.n, pairsPerFrame, perfFrames_);
+    perf_.resetTotals();
+    perfFrames_ = 0;
+    perfPairs_  = 0.0;
+}
+
+int App::run() {
     bool running = true;
+
+    // con --frames el paso es fijo: todas las corridas simulan la misma
+    // trayectoria y los tiempos se pueden comparar entre configuraciones
+    const int    warmup = std::min(5, cfg_.frames / 10);
+    const double freq   = (double)SDL_GetPerformanceFrequency();
+    int frame = 0;
+
     while (running) {
+        beginFrame();
         handleEvents(running);
         float dt = timer_.tick();
+        if (cfg_.frames > 0) dt = 1.f / 60.f;
+
+        const Uint64 t0 = SDL_GetPerformanceCounter();
         if (!paused_) update(dt);
+        else          refreshPausedView();
+        const Uint64 t1 = SDL_GetPerformanceCounter();
         render();
+        const Uint64 t2 = SDL_GetPerformanceCounter();
+        if (shm_.isOpen() && !paused_) publishFrame();
+        const Uint64 t3 = SDL_GetPerformanceCounter();
+        endFrame();
+
+        if (cfg_.frames > 0) {
+            if (frame + 1 == warmup) { perf_.resetTotals(); perfPairs_ = 0.0; }
+            if (frame >= warmup) {
+                runStats_.updateSec += (t1 - t0) / freq;
+                runStats_.renderSec += (t2 - t1) / freq;
+                runStats_.publishSec += (t3 - t2) / freq;
+                runStats_.edges     += (double)edges_.size();
+                runStats_.frames++;
+                perfFrames_++;
+            }
+            if (++frame >= cfg_.frames) running = false;
+        } else if (perf_.enabled() && ++perfFrames_ >= 120) {
+            reportPerf();
+        }
+    }
+
+    if (cfg_.frames > 0) {
+        printRunSummary();
+        reportPerf();
+        // para scripts: una corrida con --verify que encontró diferencias falla
+        if (verifyFailures_ > 0) return 2;
     }
+    return 0;
 }
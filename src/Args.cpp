@@ -23,6 +23,21 @@ bool parseArgs(int argc, char** argv, Config& out, std::string& error) {
         if (a=="-h" || a=="--help") { printHelp(); return false; }
         else if (a=="-w"   && need(i)) { if(!readInt(argv[++i], out.width))  { error="Anchura inválida"; return false; } }
         else if (a=="-hgt" && need(i)) { if(!readInt(argv[++i], out.height)) { error="Altura inválida"; return false; } }
+        else if (a=="--world" && need(i)) {
+            const char* v = argv[++i];
+            char* end = nullptr;
+            out.worldW = (int)std::strtol(v, &end, 10);
+            if (!end || (*end!='x' && *end!='X')) { error="world inválido (ANCHOxALTO)"; return false; }
+            if (!readInt(end + 1, out.worldH) || out.worldW <= 0 || out.worldH <= 0) {
+                error="world inválido (ANCHOxALTO)"; return false;
+            }
+        }
+        else if (a=="--zoom" && need(i)) {
+            if(!readFloat(argv[++i], out.zoom) || out.zoom < 0.f) { error="zoom inválido"; return false; }
+        }
+        else if (a=="--offscreen-rate" && need(i)) {
+            if(!readInt(argv[++i], out.offscreenRate) || out.offscreenRate < 1) { error="offscreen-rate inválido"; return false; }
+        }
         else if (a=="-n"   && need(i)) { if(!readInt(argv[++i], out.n))      { error="n inválido"; return false; } }
         else if (a=="-r"   && need(i)) { if(!readFloat(argv[++i], out.radius)) { error="radio inválido"; return false; } }
         else if (a=="-s"   && need(i)) { if(!readFloat(argv[++i], out.speed))  { error="speed inválido"; return false; } }
@@ -42,6 +57,62 @@ bool parseArgs(int argc, char** argv, Config& out, std::string& error) {
         else if (a=="--novsync") {
             out.novsync = true;
         }
+        else if (a=="--frames" && need(i)) {
+            if(!readInt(argv[++i], out.frames) || out.frames < 0) { error="frames inválido"; return false; }
+        }
+        else if (a=="--det") {
+            out.deterministic = true;
+        }
+        else if (a=="--verify") {
+            out.verify = true;
+        }
+        else if (a=="--perf-counters") {
+            out.perfCounters = true;
+        }
+        else if (a=="--shm" && need(i)) {
+            out.shmName = argv[++i];
+        }
+        else if (a=="--shm-slots" && need(i)) {
+            if(!readInt(argv[++i], out.shmSlots) || out.shmSlots < 2) { error="shm-slots inválido (mínimo 2)"; return false; }
+        }
+        else if (a=="--shm-max-edges" && need(i)) {
+            if(!readInt(argv[++i], out.shmMaxEdges) || out.shmMaxEdges < 0) { error="shm-max-edges inválido"; return false; }
+        }
+        else if (a=="--dist" && need(i)) {
+            std::string v = argv[++i];
+            if      (v=="uniform") out.dist = SpawnDist::Uniform;
+            else if (v=="blobs")   out.dist = SpawnDist::Blobs;
+            else if (v=="rings")   out.dist = SpawnDist::Rings;
+            else { error="dist inválido (uniform, blobs o rings)"; return false; }
+        }
+        else if (a=="--index" && need(i)) {
+            std::string v = argv[++i];
+            if      (v=="grid") out.index = IndexMode::Grid;
+            else if (v=="kd")   out.index = IndexMode::KdTree;
+            else if (v=="auto") out.index = IndexMode::Auto;
+            else { error="index inválido (grid, kd o auto)"; return false; }
+        }
+        else if (a=="--grid-build" && need(i)) {
+            std::string v = argv[++i];
+            if      (v=="counts") out.gridBuild = GridBuild::Counts;
+            else if (v=="radix")  out.gridBuild = GridBuild::Radix;
+            else if (v=="auto")   out.gridBuild = GridBuild::Auto;
+            else { error="grid-build inválido (counts, radix o auto)"; return false; }
+        }
+        else if (a=="--interact" && need(i)) {
+            std::string v = argv[++i];
+            if      (v=="off")   out.interact = InteractMode::Off;
+            else if (v=="boids") out.interact = InteractMode::Boids;
+            else if (v=="repel") out.interact = InteractMode::Repel;
+            else { error="interact inválido (off, boids o repel)"; return false; }
+        }
+        else if (a=="--cells" && need(i)) {
+            std::string v = argv[++i];
+            if (v=="auto") out.cellSubdiv = 0;
+            else if (!readInt(v.c_str(), out.cellSubdiv) || out.cellSubdiv < 1 || out.cellSubdiv > 4) {
+                error="cells inválido (1..4 o auto)"; return false;
+            }
+        }
         else {
             std::ostringstream oss; oss << "Flag no reconocida: " << a;
             error = oss.str(); return false;
@@ -63,15 +134,40 @@ Uso:
   ./omp_screensaver -n 1200 -w 1280 -hgt 720 -r 90 -s 1.0 --par --threads 8 --bench 0
 Flags:
   -n, -w, -hgt, -r, -s        parámetros visuales
+  --world <W>x<H>             mundo más grande que la ventana (def. = ventana)
+  --zoom <z>                  zoom inicial centrado (def. todo el mundo visible)
+  --offscreen-rate <K>        fuera de la vista integra 1 de cada K frames (def. 1)
   --par / --seq               modo paralelo o secuencial
-  --seed <int>                semilla RNG (opcional)
+  --seed <int>                semilla RNG (opcional); mismas partículas con
+                              cualquier cantidad de hilos
+  --dist <uniform|blobs|rings>  distribución inicial: uniforme, blobs gaussianos
+                              o anillos (para estresar el índice espacial)
   --threads <K>               fuerza K hilos en OpenMP (opcional)
   --bench <0/1>               1 = NO dibuja (mide solo cómputo)
   --novsync                   Desactiva VSync (permite FPS > 60)
+  --frames <N>                corre N frames con dt fijo (1/60 s), imprime una
+                              línea RESULT con los tiempos y termina
+  --det                       PAR determinista: aristas en el mismo orden que SEQ
+  --verify                    compara en cada frame las aristas PAR contra SEQ
+  --cells <1..4|auto>         celdas de lado r/K con stencil multi-anillo (def. 1)
+  --index <grid|kd|auto>      índice espacial: grid plano, k-d tree o automático
+  --grid-build <counts|radix|auto>
+                              armado del grid en PAR: conteos por hilo y celda o
+                              radix sort de (celda, partícula); auto según tamaño
+  --interact <off|boids|repel>  enjambre (separación/alineación/cohesión) o
+                              repulsión suave, calculados junto con las aristas
+  --perf-counters             ciclos, IPC y fallos de caché/saltos/TLB por fase
+                              (integrar, grid, aristas, merge, render, publicar)
+  --shm <nombre>              publica partículas y aristas de cada frame en un
+                              anillo de memoria compartida POSIX (/dev/shm/<nombre>)
+  --shm-slots <K>             slots del anillo (def. 4, mínimo 2)
+  --shm-max-edges <M>         aristas por slot (def. 2× los pares esperados, mínimo
+                              8·n; las que sobran se cortan)
 
 Controles:
   ↑/↓ radio, ←/→ velocidad, F1..F4 paletas,
   C auto-ciclo (ON/OFF), B cambia fondo,
   R rota (OFF → CW → CCW), Espacio pausa, ESC salir
+  Rueda zoom, arrastrar con el mouse mueve la vista, H vista completa
 )" << std::endl;
 }
@@ -0,0 +1,48 @@
+#include "Camera.h"
+#include <algorithm>
+
+void Camera::fit(float worldW, float worldH) {
+    const float z = std::min(viewW / worldW, viewH / worldH);
+    minZoom = z * 0.5f;
+    centerOn(worldW, worldH, z);
+}
+
+void Camera::centerOn(float worldW, float worldH, float z) {
+    zoom = std::min(std::max(z, minZoom), maxZoom);
+    x = worldW * 0.5f - viewW * 0.5f / zoom;
+    y = worldH * 0.5f - viewH * 0.5f / zoom;
+}
+
+void Camera::zoomAt(float factor, int sx, int sy) {
+    const float wx = x + sx / zoom;
+    const float wy = y + sy / zoom;
+    zoom = std::min(std::max(zoom * factor, minZoom), maxZoom);
+    x = wx - sx / zoom;
+    y = wy - sy / zoom;
+}
+
+void Camera::pan(int dxPixels, int dyPixels) {
+    x -= dxPixels / zoom;
+    y -= dyPixels / zoom;
+}
+
+void Camera::clampTo(float worldW, float worldH) {
+    // al menos media ventana de mundo a la vista
+    const float halfW = viewW * 0.5f / zoom;
+    const float halfH = viewH * 0.5f / zoom;
+    x = std::min(std::max(x, -halfW), worldW - halfW);
+    y = std::min(std::max(y, -halfH), worldH - halfH);
+}
+
+void Camera::visibleRect(float margin, float& x0, float& y0, float& x1, float& y1) const {
+    x0 = x - margin;
+    y0 = y - margin;
+    x1 = x + viewW / zoom + margin;
+    y1 = y + viewH / zoom + margin;
+}
+
+bool Camera::coversWorld(float worldW, float worldH) const {
+    float x0, y0, x1, y1;
+    visibleRect(0.f, x0, y0, x1, y1);
+    return x0 <= 0.f && y0 <= 0.f && x1 >= worldW && y1 >= worldH;
+}
@@ -0,0 +1,24 @@
+#include "EdgeKernels.h"
+#include <algorithm>
+#include <cmath>
+
+HalfStencil buildHalfStencil(float cellSize, float radius, int gw) {
+    HalfStencil st;
+    st.reach = std::max(1, (int)std::ceil(radius / cellSize - 1e-4f));
+
+    const float r2 = radius * radius;
+    for (int dy = 0; dy <= st.reach; ++dy) {
+        const int firstDx = (dy == 0) ? 0 : -st.reach;
+        for (int dx = firstDx; dx <= st.reach; ++dx) {
+            // distancia mínima entre dos puntos de las celdas
+            const float gapX = std::max(0, std::abs(dx) - 1) * cellSize;
+            const float gapY = std::max(0, dy - 1) * cellSize;
+            if (gapX*gapX + gapY*gapY > r2) continue;
+
+            st.dx.push_back(dx);
+            st.dy.push_back(dy);
+            st.delta.push_back(dy * gw + dx);
+        }
+    }
+    return st;
+}
@@ -0,0 +1,66 @@
+#include "FrameArena.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+static std::atomic<uint64_t> g_heapAllocs{0};
+
+uint64_t heapAllocationCount() {
+    return g_heapAllocs.load(std::memory_order_relaxed);
+}
+
+// operator new global con contador: así se puede comprobar que un frame en
+// régimen estable no reserva memoria.
+void* operator new(std::size_t size) {
+    g_heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+FrameArena::FrameArena(size_t initialBytes)
+    : block_(static_cast<char*>(::operator new(initialBytes))),
+      capacity_(initialBytes) {}
+
+FrameArena::~FrameArena() {
+    for (void* p : overflow_) ::operator delete(p);
+    ::operator delete(block_);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    const uintptr_t base    = reinterpret_cast<uintptr_t>(block_);
+    const uintptr_t aligned = (base + used_ + align - 1) & ~(uintptr_t)(align - 1);
+    const size_t    offset  = aligned - base;
+
+    if (offset + bytes <= capacity_) {
+        used_ = offset + bytes;
+        highWater_ = std::max(highWater_, used());
+        return block_ + offset;
+    }
+
+    // no alcanzó: bloque aparte hasta el próximo reset
+    void* p = ::operator new(bytes + align);
+    overflow_.push_back(p);
+    overflowBytes_ += bytes + align;
+    highWater_ = std::max(highWater_, used());
+    const uintptr_t raw = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<void*>((raw + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+void FrameArena::reset() {
+    if (!overflow_.empty()) {
+        for (void* p : overflow_) ::operator delete(p);
+        overflow_.clear();
+        overflow_.shrink_to_fit();
+
+        // un solo bloque que cubra el máximo visto, con algo de holgura
+        const size_t grown = std::max(capacity_ * 2, highWater_ + highWater_ / 4);
+        ::operator delete(block_);
+        block_    = static_cast<char*>(::operator new(grown));
+        capacity_ = grown;
+    }
+    used_          = 0;
+    overflowBytes_ = 0;
+}
@@ -0,0 +1,43 @@
+#include "Interaction.h"
+#include <algorithm>
+
+// Ganancias del enjambre, en px/s² por unidad de cada término
+static constexpr float SEPARATION_GAIN = 140.f;
+static constexpr float ALIGNMENT_GAIN  = 1.2f;
+static constexpr float COHESION_GAIN   = 0.6f;
+static constexpr float REPULSION_GAIN  = 220.f;
+
+// Rango de rapidez (px/s, antes de multiplicar por --s)
+static constexpr float MIN_SPEED = 15.f;
+static constexpr float MAX_SPEED = 90.f;
+
+void applyInteraction(Particle& p, const NeighborAccum& acc, InteractMode mode, float dt) {
+    float ax = 0.f, ay = 0.f;
+
+    if (mode == InteractMode::Boids) {
+        ax += SEPARATION_GAIN * acc.sepX;
+        ay += SEPARATION_GAIN * acc.sepY;
+        if (acc.count > 0.f) {
+            const float inv = 1.f / acc.count;
+            ax += ALIGNMENT_GAIN * (acc.velX * inv - p.vx);
+            ay += ALIGNMENT_GAIN * (acc.velY * inv - p.vy);
+            ax += COHESION_GAIN  * acc.offX * inv;
+            ay += COHESION_GAIN  * acc.offY * inv;
+        }
+    } else if (mode == InteractMode::Repel) {
+        ax += REPULSION_GAIN * acc.sepX;
+        ay += REPULSION_GAIN * acc.sepY;
+    }
+
+    p.vx += ax * dt;
+    p.vy += ay * dt;
+
+    const float v2 = p.vx*p.vx + p.vy*p.vy;
+    if (v2 > MAX_SPEED * MAX_SPEED) {
+        const float k = MAX_SPEED / std::sqrt(v2);
+        p.vx *= k; p.vy *= k;
+    } else if (mode == InteractMode::Boids && v2 > 1e-6f && v2 < MIN_SPEED * MIN_SPEED) {
+        const float k = MIN_SPEED / std::sqrt(v2);
+        p.vx *= k; p.vy *= k;
+    }
+}
@@ -0,0 +1,115 @@
+#include "KdTree.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef USE_OPENMP
+  #include <omp.h>
+#endif
+
+// Por debajo de este tamaño un subárbol se arma en la misma tarea.
+static constexpr int KD_TASK_CUTOFF = 4096;
+
+// (hojas(k), hojas(k+1)) en O(log k): los hijos de un nodo difieren en a lo
+// sumo una partícula, así que basta con arrastrar el par de conteos.
+static std::pair<int, int> kdLeafPair(int k) {
+    if (k <  KdTree::KD_LEAF_SIZE) return { 1, 1 };
+    if (k == KdTree::KD_LEAF_SIZE) return { 1, 2 };
+    const std::pair<int, int> half = kdLeafPair(k / 2);
+    if (k % 2 == 0) return { 2 * half.first, half.first + half.second };
+    return { half.first + half.second, 2 * half.second };
+}
+
+static int kdLeafCount(int count) { return kdLeafPair(count).first; }
+static int kdNodeCount(int count) { return 2 * kdLeafCount(count) - 1; }
+
+void KdTree::build(const std::vector<Particle>& particles, int maxThreads) {
+    ps_ = particles.data();
+    const int n = (int)particles.size();
+
+    nodes_.resize(kdNodeCount(n));
+    leafNode_.resize(kdLeafCount(n));
+    leafOffsets_.resize(leafNode_.size() + 1);
+    items_.resize(n);
+    for (int i = 0; i < n; ++i) items_[i] = i;
+    leafOffsets_.back() = n;
+
+#ifdef USE_OPENMP
+    if (maxThreads > 1 && n > KD_TASK_CUTOFF) {
+        #pragma omp parallel num_threads(maxThreads)
+        #pragma omp single
+        buildNode(0, 0, n, 0, true);
+        return;
+    }
+#else
+    (void)maxThreads;
+#endif
+    buildNode(0, 0, n, 0, false);
+}
+
+// Arma el nodo `node` sobre items[begin, end). Los ids de nodo y de hoja salen
+// solo de los tamaños, así que cada tarea escribe en posiciones propias.
+void KdTree::buildNode(int node, int begin, int end, int firstLeaf, bool spawnTasks) {
+    KdNode& nd = nodes_[node];
+    nd.begin = begin;
+    nd.end   = end;
+
+    float minX = ps_[items_[begin]].x, maxX = minX;
+    float minY = ps_[items_[begin]].y, maxY = minY;
+    for (int i = begin + 1; i < end; ++i) {
+        const Particle& p = ps_[items_[i]];
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+    nd.minX = minX; nd.minY = minY;
+    nd.maxX = maxX; nd.maxY = maxY;
+
+    const int count = end - begin;
+    if (count <= KD_LEAF_SIZE) {
+        nd.right     = -1;
+        nd.leafBegin = firstLeaf;
+        nd.leafEnd   = firstLeaf + 1;
+        leafNode_[firstLeaf]    = node;
+        leafOffsets_[firstLeaf] = begin;
+        return;
+    }
+
+    // mediana sobre el eje más largo de la caja
+    const int  half  = count / 2;
+    const int  mid   = begin + half;
+    const bool splitX = (maxX - minX) >= (maxY - minY);
+    const Particle* ps = ps_;
+    std::nth_element(items_.begin() + begin, items_.begin() + mid, items_.begin() + end,
+        [ps, splitX](int a, int b) {
+            return splitX ? ps[a].x < ps[b].x : ps[a].y < ps[b].y;
+        });
+
+    const int leftNode  = node + 1;
+    const int rightNode = node + 1 + kdNodeCount(half);
+    const int rightLeaf = firstLeaf + kdLeafCount(half);
+
+    nd.right     = rightNode;
+    nd.leafBegin = firstLeaf;
+    nd.leafEnd   = rightLeaf + kdLeafCount(count - half);
+
+    if (spawnTasks && count > KD_TASK_CUTOFF) {
+#ifdef USE_OPENMP
+        #pragma omp task
+        buildNode(leftNode, begin, mid, firstLeaf, true);
+        buildNode(rightNode, mid, end, rightLeaf, true);
+        #pragma omp taskwait
+        return;
+#endif
+    }
+    buildNode(leftNode,  begin, mid, firstLeaf, false);
+    buildNode(rightNode, mid,   end, rightLeaf, false);
+}
+
+KdView KdTree::view(const Particle* particles, float r2, float invR2) const {
+    KdView kv;
+    kv.pairs = GridView{ particles, leafOffsets_.data(), items_.data(),
+                         leafCount(), 1, r2, invR2,
+                         nullptr, nullptr, nullptr, 0, 0 };
+    kv.nodes    = nodes_.data();
+    kv.leafNode = leafNode_.data();
+    return kv;
+}
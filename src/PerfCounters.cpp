@@ -0,0 +1,168 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+static const char* const PHASE_NAMES[(int)PerfPhase::Count] = {
+    "otros", "integrar", "grid", "aristas", "merge", "render", "publicar"
+};
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (auto& g : groups_) {
+        for (int e = 0; e < NumEvents; ++e) {
+            if (g.fd[e] >= 0) close(g.fd[e]);
+        }
+    }
+#endif
+}
+
+#ifdef __linux__
+static int openEvent(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = (groupFd == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP |
+                          PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1: el hilo que llama, en cualquier CPU
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+static uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+bool PerfCounters::openForThread(int tid) {
+#ifdef __linux__
+    if ((int)groups_.size() <= tid) groups_.resize(tid + 1);
+    ThreadGroup& g = groups_[tid];
+    for (int e = 0; e < NumEvents; ++e) { g.fd[e] = -1; g.slot[e] = -1; g.last[e] = 0.0; }
+
+    const struct { uint32_t type; uint64_t config; } events[NumEvents] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D) },
+        { PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB) },
+    };
+
+    // sin el líder (ciclos) no hay grupo; los demás eventos son opcionales
+    g.fd[Cycles] = openEvent(events[Cycles].type, events[Cycles].config, -1);
+    if (g.fd[Cycles] < 0) {
+        error_ = std::strerror(errno);
+        return false;
+    }
+    g.slot[Cycles] = g.opened++;
+    for (int e = Instructions; e < NumEvents; ++e) {
+        g.fd[e] = openEvent(events[e].type, events[e].config, g.fd[Cycles]);
+        if (g.fd[e] >= 0) g.slot[e] = g.opened++;
+    }
+
+    ioctl(g.fd[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(g.fd[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    readGroup(g, g.last);
+    return true;
+#else
+    (void)tid;
+    error_ = "perf_event_open solo existe en Linux";
+    return false;
+#endif
+}
+
+// Lee el grupo y escala por multiplexado (tiempo habilitado / corriendo).
+bool PerfCounters::readGroup(ThreadGroup& g, double* scaled) {
+#ifdef __linux__
+    uint64_t buf[3 + NumEvents];
+    if (g.fd[Cycles] < 0) return false;
+    const ssize_t got = read(g.fd[Cycles], buf, sizeof(buf));
+    if (got < (ssize_t)(3 * sizeof(uint64_t))) return false;
+
+    const uint64_t nr      = buf[0];
+    const uint64_t enabled = buf[1];
+    const uint64_t running = buf[2];
+    const double   scale   = running ? (double)enabled / running : 0.0;
+    for (int e = 0; e < NumEvents; ++e) {
+        const int s = g.slot[e];
+        scaled[e] = (s >= 0 && (uint64_t)s < nr) ? buf[3 + s] * scale : 0.0;
+    }
+    return true;
+#else
+    (void)g; (void)scaled;
+    return false;
+#endif
+}
+
+void PerfCounters::markSlow(PerfPhase next) {
+    double now[NumEvents];
+    for (auto& g : groups_) {
+        if (!readGroup(g, now)) continue;
+        for (int e = 0; e < NumEvents; ++e) {
+            totals_[(int)current_][e] += now[e] - g.last[e];
+            g.last[e] = now[e];
+        }
+    }
+    current_ = next;
+}
+
+void PerfCounters::resetTotals() {
+    for (auto& phase : totals_) {
+        for (double& v : phase) v = 0.0;
+    }
+}
+
+void PerfCounters::report(std::ostream& os, double particles, double candidatePairs, long frames) {
+    if (!enabled_ || frames <= 0) return;
+
+    // eventos que ningún hilo pudo abrir se muestran como "-"
+    bool available[NumEvents] = {};
+    for (const auto& g : groups_) {
+        for (int e = 0; e < NumEvents; ++e) available[e] |= (g.slot[e] >= 0);
+    }
+
+    const double perFrame = 1.0 / frames;
+    auto cell = [&](double v, bool ok) {
+        if (ok) os << std::setw(10) << std::fixed << std::setprecision(3) << v;
+        else    os << std::setw(10) << "-";
+    };
+
+    os << "[perf] " << frames << " frames, N=" << (long)particles
+       << ", pares candidatos/frame=" << (long)candidatePairs << "\n"
+       << "[perf] fase       Mciclos/f       IPC   L1D/part   LLC/part  brMiss/part  dTLB/part  L1D/par\n";
+    for (int p = 1; p < (int)PerfPhase::Count; ++p) {
+        const double* t = totals_[p];
+        const double cycles = t[Cycles] * perFrame;
+        const double ipc    = t[Cycles] > 0 ? t[Instructions] / t[Cycles] : 0.0;
+        const double perP   = particles > 0 ? perFrame / particles : 0.0;
+
+        os << "[perf] " << std::left << std::setw(9) << PHASE_NAMES[p] << std::right;
+        cell(cycles * 1e-6, true);
+        cell(ipc, available[Instructions]);
+        cell(t[L1DMisses] * perP, available[L1DMisses]);
+        cell(t[LLCMisses] * perP, available[LLCMisses]);
+        os << "  "; cell(t[BranchMisses] * perP, available[BranchMisses]);
+        cell(t[DTLBMisses] * perP, available[DTLBMisses]);
+        // por par candidato solo tiene sentido en el barrido de pares
+        const bool pairs = (p == (int)PerfPhase::Edges && candidatePairs > 0);
+        cell(pairs ? t[L1DMisses] * perFrame / candidatePairs : 0.0,
+             pairs && available[L1DMisses]);
+        os << "\n";
+    }
+    os.flush();
+}
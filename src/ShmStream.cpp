@@ -0,0 +1,214 @@
+#include "ShmStream.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <signal.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define SHM_POSIX 1
+#endif
+
+#ifdef SHM_POSIX
+static std::string shmPath(const std::string& name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+ShmPublisher::~ShmPublisher() {
+    if (!base_) return;
+    header_->state.store(SHM_CLOSED, std::memory_order_release);
+    munmap(base_, bytes_);
+    shm_unlink(name_.c_str());
+}
+
+// ¿Hay un publicador vivo en `path`? Un segmento sin magic válido, cerrado
+// o de un proceso que ya no existe (se cayó sin cerrar) se puede reemplazar.
+static bool segmentInUse(const std::string& path, int& pid) {
+    pid = 0;
+    const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    bool live = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(ShmRingHeader)) {
+        void* p = mmap(nullptr, sizeof(ShmRingHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            const ShmRingHeader* h = static_cast<const ShmRingHeader*>(p);
+            if (h->magic == SHM_MAGIC && h->state.load(std::memory_order_acquire) == SHM_LIVE) {
+                // de otra versión no se sabe leer el pid: se asume vivo
+                if (h->version != SHM_VERSION) {
+                    live = true;
+                } else {
+                    pid  = h->publisherPid;
+                    live = pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+                }
+            }
+            munmap(p, sizeof(ShmRingHeader));
+        }
+    }
+    close(fd);
+    return live;
+}
+
+bool ShmPublisher::open(const std::string& name, int slots, uint32_t maxParticles,
+                        uint32_t maxEdges, float worldW, float worldH, std::string& error) {
+    name_   = shmPath(name);
+    layout_ = ShmSlotLayout::make(maxParticles, maxEdges);
+
+    const size_t slotsOffset = 4096;
+    bytes_ = slotsOffset + layout_.bytes * (size_t)slots;
+
+    // un segmento de una corrida anterior se reemplaza; el de un publicador
+    // vivo no, porque sus lectores nunca verían SHM_CLOSED
+    int owner = 0;
+    if (segmentInUse(name_, owner)) {
+        error = name_ + " ya tiene un publicador vivo" +
+                (owner > 0 ? " (pid " + std::to_string(owner) + ")" : std::string()) +
+                "; usar otro nombre";
+        return false;
+    }
+    shm_unlink(name_.c_str());
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        error = "shm_open(" + name_ + "): " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, (off_t)bytes_) != 0) {
+        error = std::string("ftruncate: ") + std::strerror(errno);
+        close(fd);
+        shm_unlink(name_.c_str());
+        return false;
+    }
+#ifdef __linux__
+    // ftruncate deja el segmento disperso: sin reservar, la primera escritura
+    // a una página que /dev/shm no puede respaldar mata el proceso con SIGBUS
+    const int err = posix_fallocate(fd, 0, (off_t)bytes_);
+    if (err != 0) {
+        error = "posix_fallocate(" + std::to_string(bytes_ >> 20) + " MB): " + std::strerror(err);
+        close(fd);
+        shm_unlink(name_.c_str());
+        return false;
+    }
+#endif
+    base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        error = std::string("mmap: ") + std::strerror(errno);
+        shm_unlink(name_.c_str());
+        return false;
+    }
+
+    header_ = new (base_) ShmRingHeader{};
+    header_->version      = SHM_VERSION;
+    header_->slotCount    = (uint32_t)slots;
+    header_->maxParticles = maxParticles;
+    header_->maxEdges     = maxEdges;
+    header_->worldW       = worldW;
+    header_->worldH       = worldH;
+    header_->slotBytes    = layout_.bytes;
+    header_->slotsOffset  = slotsOffset;
+    header_->latestFrame.store(0, std::memory_order_relaxed);
+    header_->state.store(SHM_LIVE, std::memory_order_relaxed);
+    header_->publisherPid = (int32_t)getpid();
+    for (int s = 0; s < slots; ++s) {
+        char* slot = static_cast<char*>(base_) + slotsOffset + layout_.bytes * s;
+        new (slot) ShmSlotHeader{};
+    }
+
+    // el magic va último: un lector que lo ve encuentra el resto armado
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHM_MAGIC;
+    return true;
+}
+
+ShmFrame ShmPublisher::begin(uint64_t frame, double simTime) {
+    char* slot = static_cast<char*>(base_) + header_->slotsOffset +
+                 (frame % header_->slotCount) * header_->slotBytes;
+    ShmFrame f = layout_.frame(slot);
+
+    const uint64_t seq = f.hdr->seq.load(std::memory_order_relaxed);
+    f.hdr->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    f.hdr->frame   = frame;
+    f.hdr->simTime = simTime;
+    return f;
+}
+
+void ShmPublisher::commit(const ShmFrame& f, uint32_t numParticles, uint32_t numEdges,
+                          uint32_t numEdgesTotal) {
+    f.hdr->numParticles  = numParticles;
+    f.hdr->numEdges      = numEdges;
+    f.hdr->numEdgesTotal = numEdgesTotal;
+
+    const uint64_t seq = f.hdr->seq.load(std::memory_order_relaxed);
+    f.hdr->seq.store(seq + 1, std::memory_order_release);
+    header_->latestFrame.store(f.hdr->frame, std::memory_order_release);
+}
+
+ShmReader::~ShmReader() {
+    if (base_) munmap(base_, bytes_);
+}
+
+bool ShmReader::open(const std::string& name, std::string& error) {
+    const std::string path = shmPath(name);
+    const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        error = "shm_open(" + path + "): " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) {
+        error = "segmento vacío o ilegible";
+        close(fd);
+        return false;
+    }
+    bytes_ = (size_t)st.st_size;
+    base_  = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        error = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    header_ = static_cast<const ShmRingHeader*>(base_);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->magic != SHM_MAGIC || header_->version != SHM_VERSION) {
+        error = "formato desconocido (¿publicador de otra versión?)";
+        return false;
+    }
+    layout_ = ShmSlotLayout::make(header_->maxParticles, header_->maxEdges);
+    if (layout_.bytes != header_->slotBytes ||
+        header_->slotsOffset + layout_.bytes * header_->slotCount > bytes_) {
+        error = "tamaño de slots inconsistente";
+        return false;
+    }
+    return true;
+}
+
+#else
+// sin memoria compartida POSIX (Windows): --shm no está disponible
+
+ShmPublisher::~ShmPublisher() {}
+
+bool ShmPublisher::open(const std::string&, int, uint32_t, uint32_t, float, float,
+                        std::string& error) {
+    error = "memoria compartida POSIX no disponible en esta plataforma";
+    return false;
+}
+
+ShmFrame ShmPublisher::begin(uint64_t, double) { return ShmFrame{}; }
+void ShmPublisher::commit(const ShmFrame&, uint32_t, uint32_t, uint32_t) {}
+
+ShmReader::~ShmReader() {}
+
+bool ShmReader::open(const std::string&, std::string& error) {
+    error = "memoria compartida POSIX no disponible en esta plataforma";
+    return false;
+}
+#endif
@@ -0,0 +1,88 @@
+#include "Spawn.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr float TWO_PI = 6.28318531f;
+
+// Box-Muller con dos sorteos consecutivos del contador (ctr+1 y ctr+2)
+float CounterRng::gaussian() {
+    const float u1 = std::max(uniform(), 1e-7f);
+    const float u2 = uniform();
+    return std::sqrt(-2.0f * std::log(u1)) * std::cos(TWO_PI * u2);
+}
+
+// Cada partícula usa su propio tramo de contadores (i << 4: hasta 16 valores)
+// y las formas globales (centros de blobs, anillos) uno aparte, muy arriba.
+static inline CounterRng particleRng(uint64_t key, int i) {
+    return CounterRng{ key, (uint64_t)i << 4 };
+}
+static inline CounterRng shapeRng(uint64_t key, int shape) {
+    return CounterRng{ key, (1ull << 60) + ((uint64_t)shape << 4) };
+}
+
+namespace {
+constexpr int NUM_BLOBS = 12;
+constexpr int NUM_RINGS = 6;
+
+struct Shape {
+    float cx, cy;
+    float size;     // sigma del blob o radio del anillo
+};
+}
+
+void spawnParticles(std::vector<Particle>& out, int n, int width, int height,
+                    uint64_t seed, SpawnDist dist) {
+    const uint64_t key = CounterRng::mix(seed ^ 0x5EEDC0DE5EEDC0DEull);
+    const float W = (float)width, H = (float)height;
+    const float minSide = std::min(W, H);
+
+    // formas fijas de la distribución, derivadas solo de la semilla
+    Shape shapes[NUM_BLOBS > NUM_RINGS ? NUM_BLOBS : NUM_RINGS];
+    const int numShapes = (dist == SpawnDist::Blobs) ? NUM_BLOBS :
+                          (dist == SpawnDist::Rings) ? NUM_RINGS : 0;
+    for (int s = 0; s < numShapes; ++s) {
+        CounterRng rng = shapeRng(key, s);
+        if (dist == SpawnDist::Blobs) {
+            shapes[s] = { rng.uniform(0.1f, 0.9f) * W, rng.uniform(0.1f, 0.9f) * H,
+                          rng.uniform(0.01f, 0.05f) * minSide };
+        } else {
+            const float radius = rng.uniform(0.08f, 0.3f) * minSide;
+            shapes[s] = { rng.uniform(radius, W - radius), rng.uniform(radius, H - radius),
+                          radius };
+        }
+    }
+
+    out.resize(n);
+    Particle* ps = out.data();
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < n; ++i) {
+        CounterRng rng = particleRng(key, i);
+        Particle& p = ps[i];
+
+        if (dist == SpawnDist::Uniform) {
+            p.x = rng.uniform(0.f, W);
+            p.y = rng.uniform(0.f, H);
+        } else if (dist == SpawnDist::Blobs) {
+            const Shape& b = shapes[rng.range(0, NUM_BLOBS - 1)];
+            p.x = b.cx + b.size * rng.gaussian();
+            p.y = b.cy + b.size * rng.gaussian();
+        } else {
+            const Shape& ring = shapes[rng.range(0, NUM_RINGS - 1)];
+            const float angle = rng.uniform(0.f, TWO_PI);
+            const float rad   = ring.size + 0.02f * ring.size * rng.gaussian();
+            p.x = ring.cx + rad * std::cos(angle);
+            p.y = ring.cy + rad * std::sin(angle);
+        }
+        p.x = std::min(std::max(p.x, 0.f), W - 1.f);
+        p.y = std::min(std::max(p.y, 0.f), H - 1.f);
+
+        p.vx = rng.uniform(-60.f, 60.f);
+        p.vy = rng.uniform(-60.f, 60.f);
+        p.r = (Uint8)rng.range(160, 255);
+        p.g = (Uint8)rng.range(160, 255);
+        p.b = (Uint8)rng.range(160, 255);
+    }
+}
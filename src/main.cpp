@@ -1,7 +1,15 @@
 #include "App.h"
 #include "Args.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#if defined(__linux__) && defined(USE_OPENMP)
+  #include <strings.h>
+  #include <unistd.h>
+#endif
+
 int main(int argc, char** argv) {
     Config cfg;
     std::string err;
@@ -10,8 +18,26 @@ int main(int argc, char** argv) {
         return err.empty() ? 0 : 1;
     }
 
+#if defined(__linux__) && defined(USE_OPENMP)
+    // Con --perf-counters los hilos de OpenMP que esperan entre regiones no
+    // pueden quedarse girando: sus ciclos se sumarían a la fase en curso. La
+    // política de espera se lee al cargar el runtime, así que se fija y se
+    // vuelve a ejecutar el binario.
+    if (cfg.perfCounters) {
+        const char* policy = std::getenv("OMP_WAIT_POLICY");
+        if (!policy) {
+            setenv("OMP_WAIT_POLICY", "passive", 1);
+            execv("/proc/self/exe", argv);
+            std::cerr << "[perf] no se pudo reejecutar con OMP_WAIT_POLICY=passive ("
+                      << std::strerror(errno) << "); la espera activa se suma a las fases\n";
+        } else if (strcasecmp(policy, "passive") != 0) {
+            std::cerr << "[perf] OMP_WAIT_POLICY=" << policy
+                      << ": la espera activa de los hilos se suma a las fases\n";
+        }
+    }
+#endif
+
     App app;
     if (!app.init(cfg)) return 1;
-    app.run();
-    return 0;
+    return app.run();
 }
@@ -0,0 +1,221 @@
+// Lector de ejemplo del stream --shm y prueba de rendimiento del anillo.
+//
+//   shm_reader <nombre> [--seconds S]
+//       se engancha a un omp_screensaver corriendo con --shm <nombre> y lee
+//       cada frame en el lugar (centroide, peso medio de aristas). Imprime una
+//       vez por segundo frames/s, GB/s leídos, frames salteados y reintentos
+//       del seqlock.
+//
+//   shm_reader --selftest [-n 1000000] [--edges M] [--slots K] [--seconds S]
+//       publicador y lector en el mismo proceso (dos mapeos del mismo
+//       segmento): un hilo escribe frames lo más rápido que puede y el
+//       principal los lee. Mide frames/s y GB/s de los dos lados y comprueba
+//       que ningún frame aceptado por el seqlock venga mezclado.
+
+#include "ShmStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static size_t frameBytes(uint32_t n, uint32_t m) {
+    return (size_t)n * (4 * sizeof(float) + 3) + (size_t)m * (2 * sizeof(int32_t) + sizeof(float));
+}
+
+// Lo que haría un consumidor real: recorrer todos los arreglos del frame.
+struct FrameSummary {
+    double cx = 0, cy = 0, speed2 = 0, meanW = 0;
+    uint64_t colorSum = 0, edgeSum = 0;
+    uint32_t n = 0, m = 0, total = 0;
+};
+
+static FrameSummary summarize(const ShmFrame& f) {
+    FrameSummary s;
+    s.n = f.hdr->numParticles;
+    s.m = f.hdr->numEdges;
+    s.total = f.hdr->numEdgesTotal;
+    for (uint32_t i = 0; i < s.n; ++i) {
+        s.cx += f.x[i];
+        s.cy += f.y[i];
+        s.speed2 += f.vx[i] * f.vx[i] + f.vy[i] * f.vy[i];
+        s.colorSum += f.r[i] + f.g[i] + f.b[i];
+    }
+    for (uint32_t k = 0; k < s.m; ++k) {
+        s.edgeSum += (uint32_t)f.edgeA[k] + (uint32_t)f.edgeB[k];
+        s.meanW += f.edgeW[k];
+    }
+    if (s.n) { s.cx /= s.n; s.cy /= s.n; }
+    if (s.m) s.meanW /= s.m;
+    return s;
+}
+
+static int runReader(const std::string& name, double seconds) {
+    ShmReader reader;
+    std::string error;
+    if (!reader.open(name, error)) {
+        std::fprintf(stderr, "shm_reader: %s\n", error.c_str());
+        return 1;
+    }
+    const ShmRingHeader& h = reader.header();
+    std::printf("segmento %s (pid %d): %u slots, hasta %u partículas y %u aristas, mundo %.0fx%.0f\n",
+                name.c_str(), h.publisherPid, h.slotCount, h.maxParticles, h.maxEdges,
+                h.worldW, h.worldH);
+
+    uint64_t last = 0, frames = 0, skipped = 0, retries = 0;
+    double bytes = 0;
+    FrameSummary s;
+    const Clock::time_point t0 = Clock::now();
+    Clock::time_point tick = t0;
+
+    while (seconds <= 0 || secondsSince(t0) < seconds) {
+        const uint64_t got = reader.readLatest(last, [&](const ShmFrame& f) { s = summarize(f); },
+                                               &retries);
+        if (got == 0) {
+            if (h.state.load(std::memory_order_acquire) == SHM_CLOSED) break;
+            std::this_thread::yield();
+            continue;
+        }
+        if (last) skipped += got - last - 1;
+        last = got;
+        ++frames;
+        bytes += frameBytes(s.n, s.m);
+
+        const double dt = secondsSince(tick);
+        if (dt >= 1.0) {
+            std::printf("frame %llu: %.1f frames/s, %.2f GB/s, salteados %llu, reintentos %llu | "
+                        "N=%u aristas=%u%s centro=(%.1f, %.1f) w=%.3f\n",
+                        (unsigned long long)got, frames / dt, bytes / dt * 1e-9,
+                        (unsigned long long)skipped, (unsigned long long)retries,
+                        s.n, s.m, s.total > s.m ? " (cortadas)" : "", s.cx, s.cy, s.meanW);
+            std::fflush(stdout);
+            frames = skipped = retries = 0;
+            bytes = 0;
+            tick = Clock::now();
+        }
+    }
+    return 0;
+}
+
+// Cada frame escribe su número en todos los elementos; un frame mezclado
+// tendría valores de dos frames distintos.
+static int runSelfTest(uint32_t n, uint32_t m, int slots, double seconds) {
+    const std::string name = "/shm_selftest_" + std::to_string(getpid());
+    ShmPublisher pub;
+    std::string error;
+    if (!pub.open(name, slots, n, m, 1280.f, 720.f, error)) {
+        std::fprintf(stderr, "selftest: %s\n", error.c_str());
+        return 1;
+    }
+    ShmReader reader;
+    if (!reader.open(name, error)) {
+        std::fprintf(stderr, "selftest: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::atomic<bool> stop{false};
+    uint64_t written = 0;
+    double writeSec = 0;
+
+    std::thread writer([&] {
+        const Clock::time_point t0 = Clock::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+            const uint64_t frame = written + 1;
+            ShmFrame f = pub.begin(frame, frame / 60.0);
+            const float   tag  = (float)(frame & 0xFFFFF);
+            const int32_t itag = (int32_t)(frame & 0x7FFFFFFF);
+            const uint8_t ctag = (uint8_t)frame;
+            for (uint32_t i = 0; i < n; ++i) {
+                f.x[i] = tag; f.y[i] = tag; f.vx[i] = tag; f.vy[i] = tag;
+            }
+            std::memset(f.r, ctag, n);
+            std::memset(f.g, ctag, n);
+            std::memset(f.b, ctag, n);
+            for (uint32_t k = 0; k < m; ++k) {
+                f.edgeA[k] = itag; f.edgeB[k] = itag; f.edgeW[k] = tag;
+            }
+            pub.commit(f, n, m, m);
+            written = frame;
+        }
+        writeSec = secondsSince(t0);
+    });
+
+    uint64_t last = 0, frames = 0, retries = 0, torn = 0;
+    const Clock::time_point t0 = Clock::now();
+    while (secondsSince(t0) < seconds) {
+        bool mixed = false;
+        const uint64_t got = reader.readLatest(last, [&](const ShmFrame& f) {
+            // se llama una vez por intento; vale el del intento aceptado
+            mixed = false;
+            const float first = f.x[0];
+            for (uint32_t i = 0; i < f.hdr->numParticles; ++i) {
+                mixed |= (f.x[i] != first) | (f.y[i] != first) |
+                         (f.vx[i] != first) | (f.vy[i] != first) | (f.r[i] != f.r[0]);
+            }
+            for (uint32_t k = 0; k < f.hdr->numEdges; ++k) {
+                mixed |= (f.edgeW[k] != first) | (f.edgeA[k] != f.edgeA[0]);
+            }
+        }, &retries);
+        if (got == 0) { std::this_thread::yield(); continue; }
+        torn += mixed;
+        last = got;
+        ++frames;
+    }
+    const double readSec = secondsSince(t0);
+    stop = true;
+    writer.join();
+
+    const double bytes = (double)frameBytes(n, m);
+    std::printf("selftest N=%u aristas=%u slots=%d (%.1f MB por frame)\n", n, m, slots, bytes * 1e-6);
+    std::printf("  publicador: %llu frames, %.1f frames/s, %.2f GB/s\n",
+                (unsigned long long)written, written / writeSec, written * bytes / writeSec * 1e-9);
+    std::printf("  lector:     %llu frames, %.1f frames/s, %.2f GB/s, reintentos %llu\n",
+                (unsigned long long)frames, frames / readSec, frames * bytes / readSec * 1e-9,
+                (unsigned long long)retries);
+    std::printf("  frames mezclados aceptados: %llu -> %s\n", (unsigned long long)torn,
+                torn == 0 ? "OK" : "FALLO");
+    return torn == 0 ? 0 : 2;
+}
+
+int main(int argc, char** argv) {
+    std::string name;
+    bool selftest = false;
+    uint32_t n = 1000000, m = 0;
+    int slots = 4;
+    double seconds = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto next = [&]() { return i + 1 < argc ? argv[++i] : (char*)"0"; };
+        if      (a == "--selftest") selftest = true;
+        else if (a == "-n")         n = (uint32_t)std::strtoul(next(), nullptr, 10);
+        else if (a == "--edges")    m = (uint32_t)std::strtoul(next(), nullptr, 10);
+        else if (a == "--slots")    slots = std::atoi(next());
+        else if (a == "--seconds")  seconds = std::atof(next());
+        else if (a == "-h" || a == "--help") { name.clear(); selftest = false; break; }
+        else                        name = a;
+    }
+
+    if (selftest) {
+        if (m == 0) m = 4 * n;
+        if (slots < 2) slots = 2;
+        return runSelfTest(n, m, slots, seconds > 0 ? seconds : 5.0);
+    }
+    if (name.empty()) {
+        std::fprintf(stderr,
+            "Uso: shm_reader <nombre> [--seconds S]\n"
+            "     shm_reader --selftest [-n 1000000] [--edges M] [--slots K] [--seconds S]\n");
+        return 1;
+    }
+    return runReader(name, seconds);
+}
@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Barrido de parámetros para el estudio de escalabilidad.
+
+Corre el binario sin ventana (--bench 1 --frames F, SDL_VIDEODRIVER=dummy)
+para cada combinación de N, radio, hilos, modo (SEQ/PAR) y distribución
+inicial, y genera:
+
+  runs.csv     una fila por corrida (lo que imprime la línea RESULT)
+  strong.csv   escalabilidad fuerte: N fijo, speedup y eficiencia vs. hilos
+  weak.csv     escalabilidad débil: N por hilo fijo (y el área crece con los
+               hilos para mantener la densidad), eficiencia vs. hilos
+  *.svg        gráficas simples de las dos tablas
+
+Las configuraciones chicas (N <= --small-n) corren en paralelo en procesos
+separados, repartiendo los núcleos según los hilos de cada una; las grandes
+corren solas para que los tiempos no se contaminen.
+
+Ejemplo:
+  tools/sweep.py --bin build/omp_screensaver --n 20000,80000 --r 20,40 \\
+                 --threads 1,2,4,8 --weak-n-per-thread 10000 --out sweep
+"""
+import argparse
+import csv
+import math
+import os
+import subprocess
+import sys
+import time
+from collections import OrderedDict
+
+
+def int_list(text):
+    return [int(v) for v in text.split(",") if v]
+
+
+def float_list(text):
+    return [float(v) for v in text.split(",") if v]
+
+
+def str_list(text):
+    return [v for v in text.split(",") if v]
+
+
+class Job:
+    def __init__(self, mode, threads, n, r, dist, width, height):
+        self.mode, self.threads, self.n, self.r, self.dist = mode, threads, n, r, dist
+        self.width, self.height = width, height
+        self.result = None
+
+    def key(self):
+        return (self.mode, self.threads, self.n, self.r, self.dist, self.width, self.height)
+
+    def command(self, args):
+        cmd = [args.bin, "-n", str(self.n), "-r", str(self.r),
+               "-w", str(self.width), "-hgt", str(self.height),
+               "--bench", "1", "--frames", str(args.frames),
+               "--seed", str(args.seed), "--threads", str(self.threads),
+               "--par" if self.mode == "PAR" else "--seq"]
+        if self.dist != "uniform":
+            cmd += ["--dist", self.dist]
+        cmd += args.extra.split()
+        return cmd
+
+
+def parse_result(stdout):
+    for line in stdout.splitlines():
+        if line.startswith("RESULT"):
+            fields = dict(kv.split("=", 1) for kv in line.split()[1:])
+            for k in ("update_ms", "render_ms"):
+                fields[k] = float(fields[k])
+            for k in ("threads", "n", "frames", "edges"):
+                fields[k] = int(fields[k])
+            return fields
+    return None
+
+
+def launch(job, args):
+    env = dict(os.environ)
+    env.setdefault("SDL_VIDEODRIVER", "dummy")
+    env["OMP_NUM_THREADS"] = str(job.threads)
+    return subprocess.Popen(job.command(args), stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE, text=True, env=env)
+
+
+def finish(job, proc, repeat_left, args):
+    out, err = proc.communicate()
+    res = parse_result(out)
+    if res is None:
+        sys.stderr.write("[sweep] falló: %s\n%s\n" % (" ".join(job.command(args)), err))
+        return
+    # con --repeat se queda el mejor tiempo
+    if job.result is None or res["update_ms"] < job.result["update_ms"]:
+        job.result = res
+    print("[sweep] %-3s t=%-2d n=%-8d r=%-5g %-8s %8.3f ms/frame%s" % (
+        job.mode, job.threads, job.n, job.r, job.dist, res["update_ms"],
+        "" if repeat_left == 0 else " (rep)"))
+
+
+def run_jobs(jobs, args):
+    small = [j for j in jobs if j.n <= args.small_n]
+    large = [j for j in jobs if j.n > args.small_n]
+
+    # chicas: en paralelo mientras la suma de hilos quepa en los núcleos
+    for rep in range(args.repeat):
+        pending = list(small)
+        running = []
+        while pending or running:
+            used = sum(j.threads for j, _ in running)
+            while pending and (not running or used + pending[0].threads <= args.jobs):
+                job = pending.pop(0)
+                running.append((job, launch(job, args)))
+                used += job.threads
+            still = []
+            for job, proc in running:
+                if proc.poll() is None:
+                    still.append((job, proc))
+                else:
+                    finish(job, proc, args.repeat - 1 - rep, args)
+            running = still
+            time.sleep(0.02)
+
+        # grandes: de a una
+        for job in large:
+            finish(job, launch(job, args), args.repeat - 1 - rep, args)
+
+
+def svg_plot(path, title, xlabel, ylabel, series, ideal=None):
+    """Gráfica de líneas mínima en SVG, sin dependencias."""
+    W, H, L, B, T, R = 640, 420, 60, 50, 40, 170
+    pts = [p for s in series.values() for p in s]
+    if ideal:
+        pts += ideal
+    if not pts:
+        return
+    xmin, xmax = min(p[0] for p in pts), max(p[0] for p in pts)
+    ymax = max(p[1] for p in pts) * 1.1 or 1.0
+    xmax = xmax if xmax > xmin else xmin + 1
+
+    def sx(x):
+        return L + (x - xmin) / (xmax - xmin) * (W - L - R)
+
+    def sy(y):
+        return H - B - y / ymax * (H - B - T)
+
+    colors = ["#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd",
+              "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"]
+    out = ['<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+           'font-family="sans-serif" font-size="12">' % (W, H),
+           '<rect width="100%" height="100%" fill="white"/>',
+           '<text x="%d" y="22" font-size="15">%s</text>' % (L, title),
+           '<line x1="%d" y1="%d" x2="%d" y2="%d" stroke="black"/>' % (L, H - B, W - R, H - B),
+           '<line x1="%d" y1="%d" x2="%d" y2="%d" stroke="black"/>' % (L, T, L, H - B),
+           '<text x="%d" y="%d" text-anchor="middle">%s</text>' % ((L + W - R) / 2, H - 12, xlabel),
+           '<text x="16" y="%d" transform="rotate(-90 16 %d)" text-anchor="middle">%s</text>'
+           % ((T + H - B) / 2, (T + H - B) / 2, ylabel)]
+    for x in sorted(set(p[0] for p in pts)):
+        out.append('<text x="%.1f" y="%d" text-anchor="middle">%g</text>' % (sx(x), H - B + 16, x))
+    for i in range(6):
+        y = ymax * i / 5
+        out.append('<text x="%d" y="%.1f" text-anchor="end">%.2f</text>' % (L - 6, sy(y) + 4, y))
+        out.append('<line x1="%d" y1="%.1f" x2="%d" y2="%.1f" stroke="#eee"/>' % (L, sy(y), W - R, sy(y)))
+
+    legend = list(series.items())
+    if ideal:
+        legend.append(("ideal", ideal))
+    for i, (name, s) in enumerate(legend):
+        color = "#999" if name == "ideal" else colors[i % len(colors)]
+        dash = ' stroke-dasharray="5,4"' if name == "ideal" else ""
+        s = sorted(s)
+        out.append('<polyline fill="none" stroke="%s" stroke-width="2"%s points="%s"/>' % (
+            color, dash, " ".join("%.1f,%.1f" % (sx(x), sy(y)) for x, y in s)))
+        for x, y in s:
+            out.append('<circle cx="%.1f" cy="%.1f" r="3" fill="%s"/>' % (sx(x), sy(y), color))
+        ly = T + 10 + i * 18
+        out.append('<line x1="%d" y1="%d" x2="%d" y2="%d" stroke="%s" stroke-width="2"%s/>' % (
+            W - R + 10, ly, W - R + 30, ly, color, dash))
+        out.append('<text x="%d" y="%d">%s</text>' % (W - R + 36, ly + 4, name))
+    out.append("</svg>")
+    with open(path, "w") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--bin", default="build/omp_screensaver", help="binario a medir")
+    ap.add_argument("--n", type=int_list, default=[20000], help="N para escalabilidad fuerte")
+    ap.add_argument("--r", type=float_list, default=[40.0], help="radios")
+    ap.add_argument("--threads", type=int_list, default=[1, 2, 4], help="hilos PAR")
+    ap.add_argument("--modes", type=str_list, default=["seq", "par"], help="seq,par")
+    ap.add_argument("--dist", type=str_list, default=["uniform"], help="distribuciones iniciales (uniform, blobs, rings)")
+    ap.add_argument("--weak-n-per-thread", type=int_list, default=[],
+                    help="N por hilo para escalabilidad débil (vacío = no medir)")
+    ap.add_argument("--width", type=int, default=1280, help="ancho del mundo (base en débil)")
+    ap.add_argument("--height", type=int, default=720, help="alto del mundo (base en débil)")
+    ap.add_argument("--frames", type=int, default=200, help="frames por corrida")
+    ap.add_argument("--repeat", type=int, default=1, help="repeticiones (se queda el mejor)")
+    ap.add_argument("--seed", type=int, default=1234)
+    ap.add_argument("--extra", default="", help="flags extra para el binario")
+    ap.add_argument("--jobs", type=int, default=os.cpu_count() or 1,
+                    help="núcleos para correr configuraciones chicas en paralelo")
+    ap.add_argument("--small-n", type=int, default=20000,
+                    help="N hasta el cual una configuración se considera chica")
+    ap.add_argument("--out", default="sweep_out", help="carpeta de salida")
+    args = ap.parse_args()
+
+    jobs = OrderedDict()
+
+    def weak_size(t):
+        # en débil el área crece con los hilos para que la densidad (y el
+        # trabajo por partícula) no cambie
+        k = math.sqrt(t)
+        return int(round(args.width * k)), int(round(args.height * k))
+
+    def add(mode, threads, n, r, dist, size=None):
+        width, height = size or (args.width, args.height)
+        job = Job(mode, threads, n, r, dist, width, height)
+        jobs.setdefault(job.key(), job)
+        return jobs[job.key()]
+
+    for dist in args.dist:
+        for r in args.r:
+            for n in args.n:
+                if "seq" in args.modes:
+                    add("SEQ", 1, n, r, dist)
+                if "par" in args.modes:
+                    for t in args.threads:
+                        add("PAR", t, n, r, dist)
+            for npt in args.weak_n_per_thread:
+                add("PAR", 1, npt, r, dist, weak_size(1))
+                for t in args.threads:
+                    add("PAR", t, npt * t, r, dist, weak_size(t))
+
+    os.makedirs(args.out, exist_ok=True)
+    run_jobs(list(jobs.values()), args)
+
+    done = [j for j in jobs.values() if j.result]
+    with open(os.path.join(args.out, "runs.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["mode", "threads", "n", "r", "dist", "width", "height", "cells", "index",
+                    "frames", "update_ms", "render_ms", "edges"])
+        for j in done:
+            res = j.result
+            w.writerow([j.mode, res["threads"], j.n, j.r, j.dist, j.width, j.height,
+                        res["cells"], res["index"],
+                        res["frames"], "%.4f" % res["update_ms"], "%.4f" % res["render_ms"],
+                        res["edges"]])
+
+    def time_of(mode, t, n, r, dist, size=None):
+        width, height = size or (args.width, args.height)
+        job = jobs.get((mode, t, n, r, dist, width, height))
+        return job.result["update_ms"] if job and job.result else None
+
+    # fuerte: la base es SEQ si se midió, si no PAR con 1 hilo
+    strong_series = OrderedDict()
+    with open(os.path.join(args.out, "strong.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["n", "r", "dist", "threads", "update_ms", "baseline", "speedup", "efficiency"])
+        for dist in args.dist:
+            for r in args.r:
+                for n in args.n:
+                    base, base_name = time_of("SEQ", 1, n, r, dist), "SEQ"
+                    if base is None:
+                        base, base_name = time_of("PAR", 1, n, r, dist), "PAR1"
+                    if base is None:
+                        continue
+                    name = "n=%d r=%g %s" % (n, r, dist)
+                    for t in args.threads:
+                        ms = time_of("PAR", t, n, r, dist)
+                        if ms is None or ms <= 0:
+                            continue
+                        sp = base / ms
+                        w.writerow([n, r, dist, t, "%.4f" % ms, base_name,
+                                    "%.3f" % sp, "%.3f" % (sp / t)])
+                        strong_series.setdefault(name, []).append((t, sp))
+    svg_plot(os.path.join(args.out, "strong_speedup.svg"),
+             "Escalabilidad fuerte (N fijo)", "hilos", "speedup", strong_series,
+             ideal=[(t, float(t)) for t in sorted(args.threads)])
+
+    weak_series = OrderedDict()
+    if args.weak_n_per_thread:
+        with open(os.path.join(args.out, "weak.csv"), "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["n_per_thread", "r", "dist", "threads", "n", "update_ms", "efficiency"])
+            for dist in args.dist:
+                for r in args.r:
+                    for npt in args.weak_n_per_thread:
+                        base = time_of("PAR", 1, npt, r, dist, weak_size(1))
+                        if base is None:
+                            continue
+                        name = "n/hilo=%d r=%g %s" % (npt, r, dist)
+                        for t in args.threads:
+                            ms = time_of("PAR", t, npt * t, r, dist, weak_size(t))
+                            if ms is None or ms <= 0:
+                                continue
+                            w.writerow([npt, r, dist, t, npt * t, "%.4f" % ms, "%.3f" % (base / ms)])
+                            weak_series.setdefault(name, []).append((t, base / ms))
+        svg_plot(os.path.join(args.out, "weak_efficiency.svg"),
+                 "Escalabilidad débil (N por hilo fijo)", "hilos", "eficiencia", weak_series,
+                 ideal=[(t, 1.0) for t in sorted(args.threads)])
+
+    print("[sweep] %d corridas, resultados en %s/" % (len(done), args.out))
+    return 0 if len(done) == len(jobs) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())